@@ -17,6 +17,9 @@
 #include <SPI.h>  //Needed by RF24.h
 #include <RF24.h>  //Needed by RF24Network.h
 #include <RF24Network.h>
+#include <TimerWheel.h>  //Software timers (see src/libraries)
+#include <EEPROM.h>  //Used by NodeIdentity.h
+#include <NodeIdentity.h>  //Heartbeats to the Central Node (see src/libraries)
 
 
 
@@ -25,8 +28,13 @@
 ///////////////////////////////////////////////////////////
 const int CHANNEL = 100;
 const uint16_t ADDRESS = 2;
+const unsigned char NODETYPE = 'S';  //Siren. Sent with the heartbeats
+const unsigned long HEARTBEATINTERVAL = 60000;  //Milliseconds between heartbeats. Must match the Central Node's
 
 const int BUZZpin = 4;
+const int SIRENBEEPS = 12;  //Beeps of an alert
+const unsigned long BEEPONTIME = 300;  //Milliseconds
+const unsigned long BEEPOFFTIME = 100;  //Milliseconds
 
 
 
@@ -38,6 +46,13 @@ const int BUZZpin = 4;
 RF24 radio(9,10);
 RF24Network network(radio);
 
+////Timers
+SizedTimerWheel<4> timers;  //16 slots per level (96 bytes): this board only has 2 KB of RAM
+Timer dotTimer;
+Timer heartbeatTimer;
+Timer sirenTimer;
+int sirenSteps = 0;  //Half-beeps (on or off) left of the current alert
+
 
 
 ///////////////////////////////////////////////////////////
@@ -62,6 +77,10 @@ void setup(void)
   //Make a signal
   StartupSound();
   
+  //Start the periodic tasks
+  timers.start(dotTimer, 500, PrintDot, NULL, 500);
+  timers.start(heartbeatTimer, HEARTBEATINTERVAL, SendHeartbeat, NULL, HEARTBEATINTERVAL);
+  
   printf_P(PSTR("\nSetup finished\n\nChecking for incoming messages\n"));
 }
 
@@ -89,12 +108,8 @@ void loop(void)
     network.read(inHeader,0,0); //Even though the message is empty, it is read to remove it from the queue
   }
   
-  //Print a dot over Serial every 0.5 s to indicate that the node is running fine
-  static long previousTime = 0;
-  if (millis()-previousTime>500){ 
-    printf_P(PSTR("."));
-    previousTime = millis();
-  }
+  //Run the timers that have expired (dots, heartbeats and the siren)
+  timers.update();
 }
 
 
@@ -119,14 +134,39 @@ void StartupSound()
 
 
 
-//Commands the buzzer to make a loud sound
+//Commands the buzzer to make a loud sound. The beeps are timed by sirenTimer, so the node keeps listening to 
+//the network meanwhile. An alert received while sounding starts the sequence again.
 void TriggerSound()
 {
-  for(int i=0;i<12;i++){
-      digitalWrite(BUZZpin,HIGH);
-      delay(300);
-      digitalWrite(BUZZpin,LOW);
-      delay(100);
-    }
+  sirenSteps = 2*SIRENBEEPS;
+  SirenStep(NULL);
 }
 
+
+
+//Turns the buzzer on or off for the next half of a beep
+void SirenStep(void* context)
+{
+  if (sirenSteps == 0) return;
+  
+  bool on = (sirenSteps % 2 == 0);
+  digitalWrite(BUZZpin, on ? HIGH : LOW);
+  sirenSteps--;
+  if (sirenSteps > 0) timers.start(sirenTimer, on ? BEEPONTIME : BEEPOFFTIME, SirenStep);
+}
+
+
+
+//Prints a dot over Serial every 0.5 s to indicate that the node is running fine
+void PrintDot(void* context)
+{
+  printf_P(PSTR("."));
+}
+
+
+
+//Tells the Central Node that this node is still alive
+void SendHeartbeat(void* context)
+{
+  if(!NodeIdentity::sendHeartbeat(network, NODETYPE)) printf_P(PSTR("\nHeartbeat failed\n"));
+}
@@ -0,0 +1,95 @@
+#include "AlertCoalescer.h"
+
+
+
+//Constructor
+AlertCoalescer::AlertCoalescer()
+{
+  for (int i=0; i<COALESCESOURCES; i++) sources[i].type = 0;
+  window = DEFAULTCOALESCEWINDOW;
+}
+
+
+
+/*
+Records an alert from the given sensor. Returns true if it starts a new alarm (so the sirens must be told), or 
+false if it has been folded into the sensor's alarm that is still active.
+*/
+bool AlertCoalescer::trigger(uint16_t node, unsigned char type)
+{
+  unsigned long now = millis();
+  AlertSource& source = findSource(node, type, now);
+  
+  bool active = (source.type != 0) && ((long)(source.activeUntil - now) > 0);
+  if (source.type == 0){  //New sensor
+    source.node = node;
+    source.type = type;
+    source.folded = 0;
+    source.total = 0;
+  }
+  
+  source.activeUntil = now + window;
+  if (source.total < 0xFFFF) source.total++;
+  if (active && (source.folded < 0xFFFF)) source.folded++;
+  return(!active);
+}
+
+
+
+//Changes how long the alarm of a sensor stays active after its last alert
+void AlertCoalescer::setWindow(unsigned long milliseconds)
+{
+  window = milliseconds;
+}
+
+
+
+//Prints the alerts received from each sensor in Serial console
+void AlertCoalescer::print()
+{
+  printf_P(PSTR("Alert window: %lu ms\n"),window);
+  unsigned long now = millis();
+  
+  for (int i=0; i<COALESCESOURCES; i++){
+    if (sources[i].type == 0) continue;
+    printf_P(PSTR("  Node %o (%c): %u alerts, %u folded"),sources[i].node,sources[i].type,sources[i].total,sources[i].folded);
+    if ((long)(sources[i].activeUntil - now) > 0) printf_P(PSTR(", active"));
+    printf_P(PSTR("\n"));
+  }
+}
+
+
+
+//Sets the alert counters of all sensors back to 0. Active alarms stay active
+void AlertCoalescer::resetCounters()
+{
+  for (int i=0; i<COALESCESOURCES; i++){
+    sources[i].folded = 0;
+    sources[i].total = 0;
+  }
+}
+
+
+
+/*
+Returns the entry of the given sensor. If the sensor isn't in the table, returns a free entry marked as unused 
+(type 0). If there are none, the entry of the sensor that has been quiet for the longest is emptied and returned.
+*/
+AlertCoalescer::AlertSource& AlertCoalescer::findSource(uint16_t node, unsigned char type, unsigned long now)
+{
+  int freeEntry = -1;
+  int oldest = 0;
+  
+  for (int i=0; i<COALESCESOURCES; i++){
+    if (sources[i].type == 0){
+      if (freeEntry < 0) freeEntry = i;
+      continue;
+    }
+    if ((sources[i].node == node) && (sources[i].type == type)) return(sources[i]);
+    if ((long)(sources[i].activeUntil - sources[oldest].activeUntil) < 0) oldest = i;
+  }
+  
+  if (freeEntry >= 0) return(sources[freeEntry]);
+  sources[oldest].type = 0;
+  return(sources[oldest]);
+}
@@ -0,0 +1,54 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This library has been made for the final project of my career, an Arduino Smart Alarm. You may reuse all or part 
+  of the included code freely for non-commercial purposes.
+  
+  Groups together repeated alerts from the same sensor. A flapping window switch or a motion detector in a busy 
+  corridor can send dozens of alerts in a few seconds, and each one would be forwarded to the sirens while they 
+  are still sounding the first. Instead, the first alert from a sensor opens a window of time (5 s by default) 
+  during which its alarm is considered active. Further alerts from the same sensor inside that window are folded 
+  into it: they extend the window, but don't cause any new message to the sirens.
+  Sensors are told apart by their address and their message type. Up to COALESCESOURCES sensors are tracked at 
+  the same time; when the table is full, the one that has been quiet for the longest is forgotten.
+*/
+
+#ifndef AlertCoalescer_h
+#define AlertCoalescer_h
+
+
+#include "Arduino.h"
+
+
+const int COALESCESOURCES = 16;
+const unsigned long DEFAULTCOALESCEWINDOW = 5000;  //Milliseconds
+
+
+
+class AlertCoalescer
+{
+  public:
+    AlertCoalescer();
+    bool trigger(uint16_t node, unsigned char type);
+    void setWindow(unsigned long milliseconds);
+    void print();
+    void resetCounters();
+    
+    
+  private:
+    struct AlertSource
+    {
+      uint16_t node;
+      unsigned char type;  //0 if the entry is unused
+      unsigned long activeUntil;  //millis() at which the alarm of this sensor stops being active
+      uint16_t folded;  //Alerts folded into an active alarm
+      uint16_t total;  //All alerts received
+    };
+    
+    AlertSource sources[COALESCESOURCES];
+    unsigned long window;
+    
+    AlertSource& findSource(uint16_t node, unsigned char type, unsigned long now);
+};
+
+
+#endif
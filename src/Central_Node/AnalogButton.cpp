@@ -1,97 +1,53 @@
 #include "AnalogButton.h"
 
 
-AnalogButton::AnalogButton(int myMin, int myMax, int myDebounceTime)
+AnalogButton::AnalogButton(const LadderDebouncer& myLadder, uint8_t myKey)
 {
-	min = myMin;
-	max = myMax;
-	debounceTime = myDebounceTime;
+  ladder = &myLadder;
+  key = myKey;
+}
+
 
-        auxTime = 0;
-        state = 0;
+
+bool AnalogButton::wasPressed() const
+{
+  return(ladder->wasPressed(key));
 }
 
 
 
-void AnalogButton::update(int analogVal)
+bool AnalogButton::wasReleased() const
 {
-  previousState = state; 
-  
-
-  switch(state){
-
-   //Not pressed
-   case 0:
-     if ((analogVal<min) || (analogVal>max))
-     {
-
-     }
-     else if ((analogVal>=min) && (analogVal<=max))  //Detected possible press
-     {
-         state = 1;
-         auxTime = millis();
-     }
-     break;
-			
-		
-
-    //Pressed? Check if its just jitter
-    case 1:
-     if ((analogVal<min) || (analogVal>max))
-     {
-       if(millis()-auxTime<debounceTime) state = 0;
-     }
-     else if ((analogVal>=min) && (analogVal<=max))
-     {
-       if(millis()-auxTime>debounceTime) state = 2;
-     }
-     break;
-      
-      
-    
-    //Pressed 
-    case 2:
-     if ((analogVal<min) || (analogVal>max))
-     {
-       state = 3;
-       auxTime = millis();
-     }
-     else if ((analogVal>=min) && (analogVal<=max))
-     {
-       
-     }
-     break;
-     
-     
-     //Released? Check if its just jitter
-     case 3:
-     if ((analogVal<min) || (analogVal>max))
-     {
-       if(millis()-auxTime>debounceTime) state = 0;
-     }
-     else if ((analogVal>=min) && (analogVal<=max))
-     {
-       if(millis()-auxTime<debounceTime) state = 2;
-     }
-     break;
-		
-
-    default:
-      break;
-  }
+  return(ladder->wasReleased(key));
+}
+
+
 
+//Returns true if the button is being held and repeated, like a key of a computer keyboard (see AnalogLadder.h)
+bool AnalogButton::wasRepeated() const
+{
+  return(ladder->wasRepeated(key));
+}
+
+
+
+//For values that can be changed by pressing the button once or by holding it down
+bool AnalogButton::wasPressedOrRepeated() const
+{
+  return(wasPressed() || wasRepeated());
 }
 
 
 
-bool AnalogButton::wasPressed()
+bool AnalogButton::isPressed() const
 {
-  return(previousState==1 && state==2);
+  return(ladder->getKey() == key);
 }
 
 
 
-bool AnalogButton::wasReleased()
+//Returns how long (ms) the button has been held down, or 0 if it isn't pressed
+unsigned long AnalogButton::getHeldTime() const
 {
-  return(previousState==3 && state==0);
+  return(isPressed() ? ladder->getHeldTime() : 0);
 }
@@ -3,35 +3,35 @@
   This library has been made for the final project of my career, an Arduino Smart Alarm. You may reuse all or part 
   of the included code freely for non-commercial purposes.
 
-  This library handles pushbuttons connected in an analog configuration (pressing them connects a voltage divider).
-  Its backend is a simple finite state machine that tracks presses and releases. It takes care of debouncing.
+  This library handles one of the pushbuttons of an analog keypad (pressing them connects a voltage divider).
+  It is only a view over the keypad's debouncer (see AnalogLadder.h), which decodes and debounces all the keys
+  together, so each button takes just a pointer and its key number.
 */
 
 #ifndef anaButt_h
 #define anaButt_h
 
 #include "Arduino.h"
+#include "AnalogLadder.h"
 
 
 
 class AnalogButton
 {
   public:
-    AnalogButton(int myMin, int myMax, int myDebounceTime);
-    void update(int analogVal);
-    bool wasPressed();
-    bool wasReleased();
+    AnalogButton(const LadderDebouncer& myLadder, uint8_t myKey);
+    bool wasPressed() const;
+    bool wasReleased() const;
+    bool wasRepeated() const;
+    bool wasPressedOrRepeated() const;
+    bool isPressed() const;
+    unsigned long getHeldTime() const;
 	
 	
   private:
 	
-    int min;
-    int max;
-    int debounceTime;
-
-    byte previousState;
-    byte state;
-    long auxTime;  //Holds the exact time the button was last pressed or released
+    const LadderDebouncer* ladder;
+    uint8_t key;
 	
 };
 
@@ -1,53 +1,57 @@
 #include "AnalogKeyboard.h"
 
 
+constexpr uint8_t KeyboardLadder::COUNT;
+constexpr LadderKey KeyboardLadder::KEYS[];
+
+
 /*
-Constructor. When an Input instance is initialized, it initializes a set of analogButton members of the class.
-Afterwards, it stores which pin will be used to get the analog reading. The voltage values have been tested empirically.
-The arguments are:     BTNname(min analog value, max analog value, debounceTime)
+Constructor. The buttons are views over the ladder, which stores which pin will be used to get the analog reading.
+The ladder is declared after the buttons, but they only keep its address, so it doesn't matter that it isn't built yet.
 */
-AnalogKeyboard::AnalogKeyboard(int myPin) : BTNSelect(20,36,30), BTNUp(290,330,30), BTNRight(178,198,30),
-                                            BTNDown(90,107,30), BTNLeft(40,61,30)
+AnalogKeyboard::AnalogKeyboard(int myPin) : BTNSelect(ladder,KEYSELECT), BTNUp(ladder,KEYUP), BTNRight(ladder,KEYRIGHT),
+                                            BTNDown(ladder,KEYDOWN), BTNLeft(ladder,KEYLEFT),
+                                            ladder(myPin,KEYBOARDDEBOUNCETIME)
 {
   pin = myPin;
 }
 
 
 
-//Must be called periodically to update the current state of the Button objects
-void AnalogKeyboard::update()
+//Starts sampling the pin in the background. Must be called from setup()
+void AnalogKeyboard::begin()
 {
-  int val = analogRead(pin);
-  
-  BTNSelect.update(val);
-  BTNUp.update(val);
-  BTNRight.update(val);
-  BTNDown.update(val);
-  BTNLeft.update(val);
+  AnalogSampler::begin(pin);
 }
 
 
 
-//Returns true if any of the direction keys was pressed (up, down, left or right)
-bool AnalogKeyboard::wasAnyArrowPressed()
+//Must be called periodically to update the current state of the Button objects
+void AnalogKeyboard::update()
 {
-  return(BTNUp.wasPressed() || BTNRight.wasPressed()  ||
-         BTNDown.wasPressed() || BTNLeft.wasPressed());
+  ladder.update(AnalogSampler::read());
 }
 
 
 
-//Returns true if any key was pressed (Select, up, down, left or right)
-bool AnalogKeyboard::wasAnyButtonPressed()
+//Changes how fast held keys repeat (see AnalogLadder.h)
+void AnalogKeyboard::setRepeat(uint16_t initialDelay, uint16_t interval, uint16_t fastestInterval)
 {
-  return(BTNSelect.wasPressed() || wasAnyArrowPressed());
-}	
-
+  ladder.setRepeat(initialDelay, interval, fastestInterval);
+}
 
 
 
+//Returns true if any of the direction keys was pressed (up, down, left or right)
+bool AnalogKeyboard::wasAnyArrowPressed() const
+{
+  return(ladder.wasAnyPressed() && ladder.getKey() != KEYSELECT);
+}
 
 
 
-                                   
-                                
+//Returns true if any key was pressed (Select, up, down, left or right)
+bool AnalogKeyboard::wasAnyButtonPressed() const
+{
+  return(ladder.wasAnyPressed());
+}
@@ -6,6 +6,8 @@
   This library handles a panel of many pushbuttons connected in an analog configuration. This makes it possible to
   work with many pushbuttons without having an instance for each one in the main sketch (they are hidden here).
   It also provides methods to easily check if any key has been pressed.
+  The keys are decoded by an AnalogLadder (see AnalogLadder.h). Their analog ranges are in KeyboardLadder below.
+  The pin is sampled and filtered in the background by AnalogSampler, so update() doesn't wait for the ADC.
 */
 
 
@@ -14,7 +16,25 @@
 #define anaKey_h
 
 
+#include "AnalogLadder.h"
 #include "AnalogButton.h"
+#include "AnalogSampler.h"
+
+
+////Analog values of each key, from lowest to highest. They have been tested empirically
+struct KeyboardLadder
+{
+  static constexpr uint8_t COUNT = 5;
+  static constexpr LadderKey KEYS[COUNT] = {{20,36}, {40,61}, {90,107}, {178,198}, {290,330}};
+};
+
+const uint8_t KEYSELECT = 0;
+const uint8_t KEYLEFT = 1;
+const uint8_t KEYDOWN = 2;
+const uint8_t KEYRIGHT = 3;
+const uint8_t KEYUP = 4;
+
+const uint8_t KEYBOARDDEBOUNCETIME = 30;  //Milliseconds
 
 
 class AnalogKeyboard
@@ -28,13 +48,18 @@ class AnalogKeyboard
     AnalogButton BTNDown;
     AnalogButton BTNLeft;
 
+    void begin();
     void update();
-    bool wasAnyArrowPressed();
-    bool wasAnyButtonPressed();	
+    void setRepeat(uint16_t initialDelay, uint16_t interval, uint16_t fastestInterval);
+    bool wasAnyArrowPressed() const;
+    bool wasAnyButtonPressed() const;
   
   
   private:
     int pin;
+    AnalogLadder<KeyboardLadder> ladder;
+    
+    AnalogKeyboard(const AnalogKeyboard&);  //Not copyable: the buttons point to the ladder of this instance
   
 };
 
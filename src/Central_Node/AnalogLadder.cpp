@@ -0,0 +1,147 @@
+#include "AnalogLadder.h"
+
+
+LadderDebouncer::LadderDebouncer(uint8_t myDebounceTime)
+{
+  debounceTime = myDebounceTime;
+
+  auxTime = 0;
+  previousState = 0;
+  state = 0;
+  activeKey = NOKEY;
+  
+  repeated = false;
+  repeating = false;
+  pressTime = 0;
+  heldTime = 0;
+  setRepeat(REPEATDELAY, REPEATINTERVAL, REPEATFASTESTINTERVAL);
+}
+
+
+
+//Changes the auto-repeat timing of held keys (in ms). A delay of 0 disables it
+void LadderDebouncer::setRepeat(uint16_t initialDelay, uint16_t interval, uint16_t fastestInterval)
+{
+  repeatDelay = initialDelay;
+  repeatInterval = interval;
+  repeatFastestInterval = min(fastestInterval, interval);
+  repeatWait = repeatDelay;
+}
+
+
+
+//Must be called with the decoded key of each sample (NOKEY if none is pressed)
+void LadderDebouncer::update(uint8_t key)
+{
+  previousState = state;
+  repeated = false;
+  unsigned long now = millis();
+  bool active = (key != NOKEY) && (key == activeKey);  //The key being tracked is still down
+
+
+  switch(state){
+
+    //Not pressed
+    case 0:
+      if (key != NOKEY)  //Detected possible press
+      {
+        state = 1;
+        activeKey = key;
+        auxTime = now;
+      }
+      break;
+
+
+    //Pressed? Check if its just jitter
+    case 1:
+      if (!active) state = 0;  //Released (or another key) before the debounce time: it was jitter
+      else if (now-auxTime > debounceTime)
+      {
+        state = 2;
+        auxTime = now;
+        pressTime = now;
+        repeatWait = repeatDelay;
+        repeating = false;
+      }
+      break;
+
+
+    //Pressed
+    case 2:
+      if (!active)
+      {
+        state = 3;
+        auxTime = now;
+      }
+      else if (repeatDelay > 0 && now-auxTime >= repeatWait)  //Held long enough to repeat
+      {
+        repeated = true;
+        auxTime = now;
+        if (!repeating) repeatWait = repeatInterval;  //First repeat
+        else repeatWait = max(repeatFastestInterval, (uint16_t)(repeatWait - repeatWait/4));
+        repeating = true;
+      }
+      break;
+
+
+    //Released? Check if its just jitter
+    case 3:
+      if (!active)
+      {
+        if (now-auxTime > debounceTime) state = 0;
+      }
+      else if (now-auxTime < debounceTime) state = 2;
+      break;
+
+
+    default:
+      break;
+  }
+  
+  heldTime = (state == 2 || state == 3) ? now-pressTime : 0;
+}
+
+
+
+bool LadderDebouncer::wasPressed(uint8_t key) const
+{
+  return(previousState==1 && state==2 && activeKey==key);
+}
+
+
+
+bool LadderDebouncer::wasReleased(uint8_t key) const
+{
+  return(previousState==3 && state==0 && activeKey==key);
+}
+
+
+
+//Returns true if the key is being held and repeated in the last update (see setRepeat())
+bool LadderDebouncer::wasRepeated(uint8_t key) const
+{
+  return(repeated && activeKey==key);
+}
+
+
+
+bool LadderDebouncer::wasAnyPressed() const
+{
+  return(previousState==1 && state==2);
+}
+
+
+
+//Returns the key that is pressed right now (debounced), or NOKEY
+uint8_t LadderDebouncer::getKey() const
+{
+  return((state == 2 || state == 3) ? activeKey : NOKEY);
+}
+
+
+
+//Returns how long (ms) the current key had been held at the last update, or 0 if no key is pressed
+unsigned long LadderDebouncer::getHeldTime() const
+{
+  return(heldTime);
+}
@@ -0,0 +1,173 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This library has been made for the final project of my career, an Arduino Smart Alarm. You may reuse all or part
+  of the included code freely for non-commercial purposes.
+
+  This library decodes a keypad of N pushbuttons connected as a resistor ladder to a single analog pin (pressing a
+  key connects a voltage divider, so each key gives a different analog value).
+
+  The keys are described by a class with a constexpr table of analog ranges, sorted from lowest to highest and
+  not overlapping:
+
+    struct MyLadder {
+      static constexpr uint8_t COUNT = 3;
+      static constexpr LadderKey KEYS[COUNT] = {{20,36}, {90,107}, {290,330}};  //{min, max} of each key
+    };
+    AnalogLadder<MyLadder> keypad(A0, 30);  //Pin, debounce time (ms)
+
+  From that table, a lookup (in flash) is built at compile time that tells, for each block of LADDERBUCKETSIZE
+  analog values, the first key that can be in it. Decoding a reading takes that lookup and one or two comparisons,
+  however many keys the ladder has. Since only one key can be read at a time, a single debouncer (LadderDebouncer)
+  tracks the key that is being pressed, and reads the time only once per sample.
+  
+  A key that is held down repeats, like on a computer keyboard: after REPEATDELAY ms it reports a repeat every 
+  REPEATINTERVAL ms, and each interval is a quarter shorter than the previous one, down to REPEATFASTESTINTERVAL ms. 
+  The timing can be changed with setRepeat(). Repeats are only reported to those who ask with wasRepeated().
+*/
+
+#ifndef anaLadder_h
+#define anaLadder_h
+
+#include "Arduino.h"
+
+
+struct LadderKey
+{
+  int min;  //Lowest analog value of the key
+  int max;  //Highest analog value of the key
+};
+
+const int LADDERADCMAX = 1023;  //analogRead() has 10 bits
+const int LADDERBUCKETBITS = 4;
+const int LADDERBUCKETSIZE = 1 << LADDERBUCKETBITS;
+const int LADDERBUCKETS = (LADDERADCMAX+1) / LADDERBUCKETSIZE;
+const uint8_t NOKEY = 0xFF;
+
+const uint16_t REPEATDELAY = 500;  //Milliseconds a key must be held before it starts repeating
+const uint16_t REPEATINTERVAL = 200;  //Milliseconds between the first repeats
+const uint16_t REPEATFASTESTINTERVAL = 25;  //Milliseconds between repeats once they have accelerated
+
+
+
+////Debouncer of the single key that can be pressed at a time. It is a simple finite state machine that tracks presses
+////and releases, like the one each AnalogButton used to have.
+class LadderDebouncer
+{
+  public:
+    LadderDebouncer(uint8_t myDebounceTime);
+    void setRepeat(uint16_t initialDelay, uint16_t interval, uint16_t fastestInterval);
+    void update(uint8_t key);
+    bool wasPressed(uint8_t key) const;
+    bool wasReleased(uint8_t key) const;
+    bool wasRepeated(uint8_t key) const;
+    bool wasAnyPressed() const;
+    uint8_t getKey() const;
+    unsigned long getHeldTime() const;
+
+
+  private:
+    uint8_t debounceTime;
+
+    uint8_t previousState;
+    uint8_t state;
+    uint8_t activeKey;  //Key being pressed or released (or the last one, once released)
+    unsigned long auxTime;  //Holds the exact time the key was last pressed, repeated or released
+    
+    ////Auto-repeat of a held key
+    uint16_t repeatDelay;
+    uint16_t repeatInterval;
+    uint16_t repeatFastestInterval;
+    uint16_t repeatWait;  //Milliseconds from auxTime to the next repeat
+    bool repeated;  //The key repeated in the last update
+    bool repeating;  //The key has repeated at least once since it was pressed
+    unsigned long pressTime;  //Time the key was pressed (after debouncing)
+    unsigned long heldTime;  //Milliseconds the key had been held at the last update
+};
+
+
+
+////Builds the flash lookup of a ladder at compile time. C++11 has no std::index_sequence, hence the helpers
+template <int... I> struct LadderIndices {};
+template <int N, int... I> struct MakeLadderIndices : MakeLadderIndices<N-1, N-1, I...> {};
+template <int... I> struct MakeLadderIndices<0, I...> { typedef LadderIndices<I...> type; };
+
+
+template <class Ladder> struct LadderTable
+{
+  //First key whose range reaches the given bucket (COUNT if none)
+  static constexpr uint8_t firstKey(int bucket, uint8_t key = 0)
+  {
+    return((key >= Ladder::COUNT) ? Ladder::COUNT :
+           (Ladder::KEYS[key].max >= bucket*LADDERBUCKETSIZE) ? key : firstKey(bucket, key+1));
+  }
+
+  //True if the ranges of the keys are valid, sorted and don't overlap
+  static constexpr bool isSorted(uint8_t key = 0)
+  {
+    return((key >= Ladder::COUNT) ? true :
+           (Ladder::KEYS[key].min > Ladder::KEYS[key].max) ? false :
+           (Ladder::KEYS[key].max > LADDERADCMAX) ? false :
+           (key > 0 && Ladder::KEYS[key].min <= Ladder::KEYS[key-1].max) ? false : isSorted(key+1));
+  }
+};
+
+
+template <class Ladder, class Indices = typename MakeLadderIndices<LADDERBUCKETS>::type> struct LadderLookup;
+
+template <class Ladder, int... I> struct LadderLookup<Ladder, LadderIndices<I...> >
+{
+  static const uint8_t TABLE[sizeof...(I)];
+};
+
+template <class Ladder, int... I>
+const uint8_t LadderLookup<Ladder, LadderIndices<I...> >::TABLE[sizeof...(I)] PROGMEM = { LadderTable<Ladder>::firstKey(I)... };
+
+
+
+////Keypad of Ladder::COUNT keys on an analog pin
+template <class Ladder> class AnalogLadder : public LadderDebouncer
+{
+  static_assert(Ladder::COUNT > 0 && Ladder::COUNT < NOKEY, "A ladder must have between 1 and 254 keys");
+  static_assert(LadderTable<Ladder>::isSorted(), "Ladder keys must be sorted by their analog value and not overlap");
+
+
+  public:
+    AnalogLadder(int myPin, uint8_t myDebounceTime) : LadderDebouncer(myDebounceTime)
+    {
+      pin = myPin;
+    }
+
+
+    //Must be called periodically to sample the pin and update the state of the keys
+    void update()
+    {
+      update(analogRead(pin));
+    }
+
+
+    //Same, with a value of the pin that has already been sampled (by AnalogSampler, for example)
+    void update(int analogVal)
+    {
+      LadderDebouncer::update(decode(analogVal));
+    }
+
+
+    //Returns the key that gives this analog value, or NOKEY if there is none
+    static uint8_t decode(int analogVal)
+    {
+      if ((analogVal < 0) || (analogVal > LADDERADCMAX)) return(NOKEY);
+
+      uint8_t key = pgm_read_byte(&LadderLookup<Ladder>::TABLE[analogVal >> LADDERBUCKETBITS]);
+      while ((key < Ladder::COUNT) && (analogVal > Ladder::KEYS[key].max)) key++;  //At most once per key in the bucket
+
+      if ((key < Ladder::COUNT) && (analogVal >= Ladder::KEYS[key].min)) return(key);
+      return(NOKEY);
+    }
+
+
+  private:
+    int pin;
+};
+
+
+#endif
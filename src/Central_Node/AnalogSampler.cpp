@@ -0,0 +1,102 @@
+#include "AnalogSampler.h"
+
+
+////Static members
+int AnalogSampler::pin = 0;
+volatile int AnalogSampler::samples[SAMPLERSIZE];
+volatile uint8_t AnalogSampler::next = 0;
+volatile int AnalogSampler::filtered = 0;
+volatile unsigned long AnalogSampler::sampleCount = 0;
+
+
+
+//Starts sampling the given analog pin (A0, A1...). Must be called from setup(), after the Arduino core has set up the ADC
+void AnalogSampler::begin(int myPin)
+{
+  pin = myPin;
+
+  //Fill the ring with a first reading, so that the filter doesn't start from zeros
+  int first = analogRead(pin);
+  for (int i = 0; i < SAMPLERSIZE; i++) samples[i] = first;
+  filtered = first;
+  next = 0;
+
+#if defined(__AVR__)
+  uint8_t channel = pin - A0;
+
+  noInterrupts();
+  ADMUX = _BV(REFS0) | (channel & 0x07);  //AVcc reference (the default of analogRead()), channel
+#if defined(MUX5)
+  ADCSRB = ((channel & 0x08) ? _BV(MUX5) : 0) | _BV(ADTS2);  //Channels 8-15 on the ATmega2560. Trigger: Timer0 overflow
+#else
+  ADCSRB = _BV(ADTS2);  //Trigger: Timer0 overflow
+#endif
+  if (channel < 8) DIDR0 |= _BV(channel);  //The digital input buffer only adds noise to an analog pin
+  ADCSRA = _BV(ADEN) | _BV(ADATE) | _BV(ADIE) | _BV(ADIF) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);  //Prescaler 128
+  interrupts();
+#endif
+}
+
+
+
+//Returns the filtered value of the pin
+int AnalogSampler::read()
+{
+#if defined(__AVR__)
+  noInterrupts();  //An int takes two reads on the ATmega, and the interrupt could change it in between
+  int value = filtered;
+  interrupts();
+  return(value);
+#else
+  addSample(analogRead(pin));
+  return(filtered);
+#endif
+}
+
+
+
+//Returns the number of samples taken since begin() (to check that the sampling is running)
+unsigned long AnalogSampler::getSampleCount()
+{
+  noInterrupts();
+  unsigned long count = sampleCount;
+  interrupts();
+  return(count);
+}
+
+
+
+//Stores a new sample in the ring and updates the filtered value
+void AnalogSampler::addSample(int value)
+{
+  samples[next] = value;
+  next = (next + 1) % SAMPLERSIZE;
+  filtered = median(samples);
+  sampleCount++;
+}
+
+
+
+//Returns the median of the SAMPLERSIZE samples. Insertion sort of a copy: it's the fastest for so few values
+int AnalogSampler::median(const volatile int* values)
+{
+  int sorted[SAMPLERSIZE];
+
+  for (int i = 0; i < SAMPLERSIZE; i++){
+    int value = values[i];
+    int j = i;
+    for (; j > 0 && sorted[j-1] > value; j--) sorted[j] = sorted[j-1];
+    sorted[j] = value;
+  }
+  return(sorted[SAMPLERSIZE/2]);
+}
+
+
+
+#if defined(__AVR__)
+//A conversion has finished
+ISR(ADC_vect)
+{
+  AnalogSampler::addSample(ADC);
+}
+#endif
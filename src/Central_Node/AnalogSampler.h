@@ -0,0 +1,51 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This library has been made for the final project of my career, an Arduino Smart Alarm. You may reuse all or part
+  of the included code freely for non-commercial purposes.
+
+  Samples an analog pin in the background and filters the readings, so that the loop never waits ~110 us for
+  analogRead() and a single noisy reading near the edge of a key's range can't make a phantom press.
+  It uses static methods, since the ADC and its interrupt can only serve one pin this way.
+
+  On the ATmega, begin() puts the ADC in auto trigger mode, started by each Timer0 overflow (the same timer millis()
+  uses, so about once per ms). The ADC interrupt stores each conversion in a ring of SAMPLERSIZE samples and keeps
+  their median up to date, so read() only has to copy a variable. While the sampler runs, analogRead() must not be
+  used for any other pin.
+  On other platforms (the native build) read() takes a new sample with analogRead() each time it is called, and
+  filters it the same way.
+*/
+
+#ifndef anaSampler_h
+#define anaSampler_h
+
+#include "Arduino.h"
+
+
+const int SAMPLERSIZE = 5;  //Samples of the median filter
+static_assert(SAMPLERSIZE % 2 == 1, "The median filter needs an odd number of samples");
+
+
+class AnalogSampler
+{
+  public:
+
+    static void begin(int pin);
+    static int read();
+    static unsigned long getSampleCount();
+
+    static void addSample(int value);  //Called from the ADC interrupt
+
+
+  private:
+
+    static int pin;
+    static volatile int samples[SAMPLERSIZE];
+    static volatile uint8_t next;  //Position in the ring of the next sample
+    static volatile int filtered;  //Median of the samples
+    static volatile unsigned long sampleCount;
+
+    static int median(const volatile int* values);
+};
+
+
+#endif
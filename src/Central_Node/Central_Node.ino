@@ -15,33 +15,46 @@
 #include "Settings.h"  //Functions to read and store user settings
 
 #include <printf.h>  //Provides with function printf(). Very useful for debugging
+#include "Log.h"  //Buffered Serial output for the messages of the libraries below
 
 #include <Wire.h>  //Used by RTClib.h
 #include <RTClib.h>  //Interface for the Real Time Clock
+#include "ClockService.h"  //Keeps the time of the Real Time Clock without reading it all the time
 
 #include <SPI.h>  //Used by RF24.h
 #include <RF24.h>  //Used by RF24Network.h
 #include <RF24Network.h>  //Used by Communications.h
+#include "SensorRegistry.h"  //Keeps the address, type and zone of every sensor node
+#include "EventLog.h"  //Keeps a record of alerts, arming and disarming
 #include "Communications.h"  //To communicate with other nodes in the network
 
-#include "analogButton.h"  //Used by analogKeyboard.h
-#include "analogKeyboard.h"  //Processes user input with the buttons
+#include "AnalogLadder.h"  //Used by analogKeyboard.h
+#include "AnalogSampler.h"  //Used by analogKeyboard.h
+#include "AnalogButton.h"  //Used by analogKeyboard.h
+#include "AnalogKeyboard.h"  //Processes user input with the buttons
 
+#include "Menu.h"  //Table of the menus, used by StateMachine.h and Display.h
 #include "StateMachine.h"  //Backend logic to navigate through menus
 
 #include <LiquidCrystal.h>  //Used by Display.h
 #include "Display.h"  //Displays screens on the LCD
 
+#include <TimerWheel.h>  //Software timers (see src/libraries)
+#include "Scheduler.h"  //Runs each of the above at its own rate
+
+#include "LoopProfiler.h"  //Measures how long each of the above takes
+
 
 
 ///////////////////////////////////////////////////////////
 ////GLOBAL VARIABLES///////////////////////////////////////
 ///////////////////////////////////////////////////////////
 
-////Declare instance for Real Time Clock control
-RTC_DS1307 clock;
+////Declare instance for Real Time Clock control. Its SQW output is connected to pin 2 (interrupt 0)
+const int SQWpin = 2;
+ClockService clock;
 
-////Prepare wireless communications
+////Prepare wireless communications. Send 'n' over Serial to print the message statistics
 Communications communications;
 
 ////Declare instance for the analog keyboard on pin A0
@@ -53,6 +66,154 @@ StateMachine stateMachine;
 ////Declare instance for LCD control
 Display display;
 
+////Declare instance for software timers (like the one that turns off the backlight)
+SizedTimerWheel<> timers;
+
+////Declare instance for running the tasks below, each one at its own rate
+Scheduler scheduler;
+
+////Declare instance for timing the tasks below. Send 'p' over Serial to print the results, 'r' to reset them
+LoopProfiler profiler;
+
+
+
+///////////////////////////////////////////////////////////
+////TASKS//////////////////////////////////////////////////
+///////////////////////////////////////////////////////////
+
+////Interact with the rest of the network (check for new messages, send alerts...). 
+////Alerts from the sensors arrive here, so it runs on every pass of loop()
+void radioTask()
+{
+  profiler.startStage();
+  communications.update();
+  profiler.endStage(STAGE_COMMUNICATIONS);
+}
+
+
+////Check for user input with the pushbuttons and update the backend logic to navigate through the menus.
+////Key presses only last until the next keyboard update, so everything that looks at them must run right after it
+void inputTask()
+{
+  profiler.startStage();
+  analogKeyboard.update();
+  profiler.endStage(STAGE_KEYBOARD);
+  
+  profiler.startStage();
+  stateMachine.update(analogKeyboard,clock);
+  display.updateBacklight(analogKeyboard);
+  profiler.endStage(STAGE_STATEMACHINE);
+}
+
+
+////Write pending settings and events to permanent storage in the background, so that the loop never waits for it
+void storageTask()
+{
+  Settings::update();
+  EventLog::update();
+}
+
+
+////Count the time of the Real Time Clock (see ClockService.h)
+void clockTask()
+{
+  clock.update();
+}
+
+
+////Update the frontend to display information on the LCD screen
+void displayTask()
+{
+  profiler.startStage();
+  display.update(stateMachine,clock);
+  profiler.endStage(STAGE_DISPLAY);
+}
+
+
+////Run the callbacks of the software timers that have expired
+void timerTask()
+{
+  timers.update();
+}
+
+
+////Send the buffered log messages over Serial, as fast as the port takes them
+void logTask()
+{
+  Log::update();
+}
+
+
+////Check that all the nodes keep sending their heartbeats
+void supervisionTask()
+{
+  SensorRegistry::checkLiveness();
+}
+
+
+////Read the octal address that follows a siren command over Serial, like the "014" of "+014". The whole line must 
+////be sent at once. Returns 0 (the Central Node, never a siren) if there is none
+uint16_t ReadSerialAddress()
+{
+  uint16_t node = 0;
+  int c;
+  while (((c = Serial.read()) >= '0') && (c <= '7')) node = node*8 + (c - '0');
+  return(node);
+}
+
+
+////Print the list of siren nodes alerts are sent to
+void PrintSirenNodes()
+{
+  printf_P(PSTR("\nSiren nodes:"));
+  for (int i=0; i<Settings::getSirenCount(); i++) printf_P(PSTR(" %o"),Settings::getSirenNode(i));
+  printf_P(PSTR("\n"));
+}
+
+
+////Listen for debugging commands sent over Serial
+void serialCommandTask()
+{
+  int command = Serial.read();
+  if (command >= 0) Log::flush();  //So that pending log messages don't get mixed with the answer
+  
+  switch(command){
+    case 'p':  //Print the loop profile
+      profiler.print();
+      break;
+      
+    case 'r':  //Reset the loop profile, the message statistics and the count of lost log bytes
+      profiler.reset();
+      communications.resetStats();
+      Log::resetLostBytes();
+      printf_P(PSTR("\nLoop profile, message statistics and lost log bytes reset\n"));
+      break;
+      
+    case 'n':  //Print the message statistics and how much of the log was lost
+      communications.printStats();
+      printf_P(PSTR("Log bytes lost: %lu\n"),Log::getLostBytes());
+      break;
+      
+    case 's':  //Print the registered sensor nodes
+      SensorRegistry::print();
+      break;
+      
+    case 'e':  //Print the event log
+      EventLog::startDump();
+      break;
+      
+    case '+':  //Add a siren node, like "+014"
+    case '-': {  //Remove a siren node, like "-014"
+      uint16_t node = ReadSerialAddress();
+      bool done = false;
+      if (node != 0) done = (command == '+') ? Settings::addSirenNode(node) : Settings::removeSirenNode(node);
+      if (!done) printf_P(PSTR("\nSiren list not changed\n"));
+      PrintSirenNodes();
+      break;
+    }
+  }
+}
+
 
 
 
@@ -70,17 +231,38 @@ void setup()
   
   ////Setup the real time clock
   Wire.begin();
-  clock.begin();
+  clock.begin(SQWpin);
   //clock.adjust(DateTime(__DATE__, __TIME__));  //Adjusts the Real Time Clock to this computer's own clock.
                                                  //Use once, recomment and reupload, or the time will be reverted at each reset. 
   
+  ////Load the user settings and the registered sensors from the EEPROM
+  Settings::begin();
+  SensorRegistry::begin();
+  EventLog::begin();
+  EventLog::setClock(clock);
+  EventLog::add(EVENT_POWERON, 0);  //Node 0: the Central Node itself
+  
   ////Setup wireless communications     
   communications.begin();
   
   ////Setup LCD screen
-  display.Begin();
+  display.Begin(timers);
+  
+  ////Start sampling the keyboard in the background
+  analogKeyboard.begin();
+  
+  ////Setup the tasks. Arguments: (function, period [us], priority, deadline [us])
+  scheduler.addTask(radioTask, 0, 0, 0);  //Every pass
+  scheduler.addTask(storageTask, 0, 0, 0);  //Every pass
+  scheduler.addTask(logTask, 0, 0, 0);  //Every pass
+  scheduler.addTask(timerTask, 0, 0, 0);  //Every pass
+  scheduler.addTask(clockTask, 100000, 1, 100000);  //10 Hz
+  scheduler.addTask(inputTask, 5000, 2, 5000);  //200 Hz
+  scheduler.addTask(displayTask, 100000, 1, 50000);  //10 Hz
+  scheduler.addTask(serialCommandTask, 100000, 0, 100000);  //10 Hz
+  scheduler.addTask(supervisionTask, 1000000, 0, 1000000);  //1 Hz
 
-  printf_P(PSTR("\nSetup finished"));
+  printf_P(PSTR("\nSetup finished\n"));
 }
 
 
@@ -89,16 +271,7 @@ void setup()
 ///////////////////////////////////////////////////////////
 void loop()
 {     
-  ////Interact with the rest of the network (check for new messages, send alerts...)
-  communications.update();
-  
-  ////Check for user input with the pushbuttons
-  analogKeyboard.update();
-  
-  ////Update the backend logic to navigate through the menus
-  stateMachine.update(analogKeyboard,clock);
-  
-  ////Update the frontend to display information on the LCD screen
-  display.update(stateMachine,analogKeyboard,clock);
+  ////Run whichever tasks are due (see setup() for the list)
+  scheduler.run();
 }
 
@@ -0,0 +1,151 @@
+#include "ClockService.h"
+
+
+volatile uint8_t ClockService::pulses = 0;
+
+
+
+ClockService::ClockService()
+{
+  usingSqw = false;
+  time = 0;
+  timeMillis = 0;
+  secondsSinceRead = 0;
+  reads = 0;
+}
+
+
+
+/*
+Starts the clock and reads the time. If the SQW output of the DS1307 is connected to sqwPin (which must be able to
+trigger an interrupt, like pin 2 or 3), its pulses are used to count the seconds. It is an open drain output, so
+the internal pull-up is turned on.
+*/
+void ClockService::begin(int sqwPin)
+{
+  rtc.begin();
+  read();
+
+  if (sqwPin != CLOCKNOSQW){
+    rtc.writeSqwPinMode(SquareWave1HZ);
+    pinMode(sqwPin, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(sqwPin), onPulse, FALLING);  //The DS1307 changes the seconds on the falling edge
+    usingSqw = true;
+  }
+}
+
+
+
+//Must be called regularly (a few times per second) to count the time
+void ClockService::update()
+{
+  unsigned long currentMillis = millis();
+
+  if (usingSqw){
+    noInterrupts();
+    uint8_t newPulses = pulses;
+    pulses = 0;
+    interrupts();
+
+    if (newPulses > 0){
+      time += newPulses;
+      timeMillis = currentMillis;
+      secondsSinceRead += newPulses;
+    }
+    else if (currentMillis - timeMillis > CLOCKSQWTIMEOUT){
+      LOG_WARNING("No pulses from the clock's SQW output. Counting time with millis()\n");
+      usingSqw = false;
+    }
+  }
+
+  else if (currentMillis - timeMillis >= 1000){  //Count the whole seconds, and keep the rest for later
+    unsigned long seconds = (currentMillis - timeMillis) / 1000;
+    time += seconds;
+    timeMillis += seconds * 1000;
+    secondsSinceRead += seconds;
+  }
+
+  if (secondsSinceRead >= CLOCKRESYNCINTERVAL) read();
+}
+
+
+
+//Returns the current date and time, without reading the clock
+DateTime ClockService::now() const
+{
+  return(DateTime(unixtime()));
+}
+
+
+
+//Returns the current Unix time, without reading the clock
+uint32_t ClockService::unixtime() const
+{
+  if (usingSqw) return(time);
+  return(time + (millis() - timeMillis) / 1000);  //update() may not have counted the last second yet
+}
+
+
+
+//Sets the clock, and the counted time with it
+void ClockService::adjust(const DateTime& dateTime)
+{
+  rtc.adjust(dateTime);
+  time = dateTime.unixtime();
+  timeMillis = millis();
+  secondsSinceRead = 0;
+}
+
+
+
+//Returns true if the seconds are being counted with the SQW output of the clock
+bool ClockService::isUsingSqw() const
+{
+  return(usingSqw);
+}
+
+
+
+//Returns how many times the clock has been read over I2C
+unsigned long ClockService::getReads() const
+{
+  return(reads);
+}
+
+
+
+/*
+Reads the time from the clock (an I2C transaction). The pulses counted until then are already included in the time 
+read, so they are cleared afterwards. A pulse that arrives during the transaction may or may not be included, so 
+in that case the clock is read again.
+*/
+void ClockService::read()
+{
+  uint32_t readTime;
+  bool pulsed;
+  do{
+    noInterrupts();
+    pulses = 0;
+    interrupts();
+    
+    readTime = rtc.now().unixtime();
+    
+    noInterrupts();
+    pulsed = (pulses > 0);
+    pulses = 0;
+    interrupts();
+  } while (pulsed);
+  
+  time = readTime;
+  timeMillis = millis();
+  secondsSinceRead = 0;
+  reads++;
+}
+
+
+
+//Interrupt of the SQW output: one more second
+void ClockService::onPulse()
+{
+  pulses++;
+}
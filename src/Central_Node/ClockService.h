@@ -0,0 +1,63 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This library has been made for the final project of my career, an Arduino Smart Alarm. You may reuse all or part
+  of the included code freely for non-commercial purposes.
+
+  Keeps the time of the Real Time Clock (DS1307) for everything in the Central Node that needs it (the screens, the
+  menus that change the time and the event log), so that the clock doesn't have to be read over I2C each time.
+  The time is read from the clock once, and then counted:
+   - With the clock's square wave output (SQW), if it is wired to an interrupt pin: the DS1307 is set to give 1 pulse
+     per second, and each pulse adds a second. The time is read again every CLOCKRESYNCINTERVAL seconds, just in case.
+   - Otherwise, with millis(), reading the clock again every CLOCKRESYNCINTERVAL seconds to correct the drift of the
+     Arduino's oscillator. This is also used if the pulses stop arriving.
+  now() only converts the counted time into a DateTime. adjust() sets both the clock and the counted time.
+*/
+
+#ifndef ClockServ_h
+#define ClockServ_h
+
+
+#include "Arduino.h"
+#include <RTClib.h>
+#include "Log.h"
+
+
+const int CLOCKNOSQW = -1;  //Pin for begin() when the SQW output is not connected
+const unsigned long CLOCKRESYNCINTERVAL = 60;  //Seconds between readings of the clock
+const unsigned long CLOCKSQWTIMEOUT = 2500;  //Milliseconds without pulses after which they are not trusted anymore
+
+
+class ClockService
+{
+  public:
+
+    ClockService();
+    void begin(int sqwPin = CLOCKNOSQW);
+    void update();
+
+    DateTime now() const;
+    uint32_t unixtime() const;
+    void adjust(const DateTime& dateTime);
+
+    bool isUsingSqw() const;
+    unsigned long getReads() const;
+
+
+  private:
+
+    RTC_DS1307 rtc;
+    bool usingSqw;
+
+    uint32_t time;  //Unix time at the last pulse or reading of the clock...
+    unsigned long timeMillis;  //...and millis() at that moment
+    unsigned long secondsSinceRead;  //Seconds counted since the clock was last read
+    unsigned long reads;
+
+    static volatile uint8_t pulses;  //Pulses of the SQW output not yet counted
+    static void onPulse();
+
+    void read();
+};
+
+
+#endif
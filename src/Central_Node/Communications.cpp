@@ -11,11 +11,52 @@ const uint16_t ADDRESS = 0;  //Central Node always has adress 0
 
 
 
+////Message types understood by the Central Node: type, payload size in bytes and handler
+const Communications::MessageType Communications::MESSAGETYPES[] = {
+  {'A', 0,              &Communications::handleActivation},            //Key Tray Node: user pressed * to activate the alarm
+  {'B', PASSCODELENGTH, &Communications::handlePasscodeVerification},  //Key Tray Node: passcode to verify
+  {'D', PASSCODELENGTH, &Communications::handleNewPasscode},           //Key Tray Node: new passcode to add to database
+  {'E', 0,              &Communications::handleSensorAlert},           //Movement Detector Node triggered
+  {'G', 0,              &Communications::handleSensorAlert},           //Window Node triggered
+  {'R', 2,              &Communications::handleRegistration},          //Sensor node powered on: its type and zone
+  {'H', 2,              &Communications::handleHeartbeat},             //Any node: still alive. Its type and zone
+};
 
-//Constructor. The RF24 and RF24Network data members are initialized here, in the initializer list
-Communications::Communications() : radio(CEpin,SCNpin),network(radio)
+const int Communications::NUMMESSAGETYPES = sizeof(MESSAGETYPES) / sizeof(MESSAGETYPES[0]);
+const int NUMDISPATCHENTRIES = 'Z' - 'A' + 1;
+
+
+
+//Finds a message type in MESSAGETYPES at compile time. Returns an empty entry (type 0) if it isn't listed
+constexpr Communications::MessageType Communications::lookupType(unsigned char type, int index)
 {
+  return((index == NUMMESSAGETYPES) ? MessageType{0, 0, NULL} :
+         (MESSAGETYPES[index].type == type) ? MESSAGETYPES[index] : lookupType(type, index+1));
+}
+
+
+
+//Dispatch table, indexed by message type ('A' is entry 0). Built at compile time from MESSAGETYPES and kept in flash
+const Communications::MessageType Communications::DISPATCHTABLE[NUMDISPATCHENTRIES] PROGMEM = {
+  lookupType('A',0), lookupType('B',0), lookupType('C',0), lookupType('D',0), lookupType('E',0), lookupType('F',0),
+  lookupType('G',0), lookupType('H',0), lookupType('I',0), lookupType('J',0), lookupType('K',0), lookupType('L',0),
+  lookupType('M',0), lookupType('N',0), lookupType('O',0), lookupType('P',0), lookupType('Q',0), lookupType('R',0),
+  lookupType('S',0), lookupType('T',0), lookupType('U',0), lookupType('V',0), lookupType('W',0), lookupType('X',0),
+  lookupType('Y',0), lookupType('Z',0)
+};
 
+
+
+
+//Constructor. The RF24 and RF24Network data members are initialized here, in the initializer list
+Communications::Communications() : radio(CEpin,SCNpin),network(radio),outbound(network)
+{
+  setWorkBudget(DEFAULTBATCHMESSAGES, DEFAULTBATCHMICROS);
+  resetStats();
+  for (int i=0; i<MAXSIRENNODES; i++){
+    sirenAlerts[i] = -1;
+    sirenAlertStates[i] = DELIVERY_FREE;
+  }
 }
 
 
@@ -34,171 +75,308 @@ void Communications::begin()
 This is the brain of the Central Node communications. It checks for incoming messages, 
 analyses them and performs corresponding actions (updating internal variables, sending 
 messages to other nodes, etc.).
+All waiting messages are handled in one go, within the work budget set with setWorkBudget().
 */
 void Communications::update()
 {
   network.update();  //Must be called regularly
+  if (radio.rxFifoFull()) rxFifoFull++;
+  
+  unsigned long start = micros();
+  uint8_t batch = 0;
   
-  ////
-  //Things to do when a message arrives
-  ////
-  if(network.available()){
+  while(network.available()){
+    if ((batch >= batchMessages) || (micros() - start >= batchMicros)){
+      budgetExhausted++;
+      break;
+    }
     
-    RF24NetworkHeader inHeader;  //A header object is like the envelope of the message. It contains information about the 
-    network.peek(inHeader);      //contents of the message so that we can know which datatype it contains (null, int, 
-                                 //boolean, array...) before actually reading it
-    printf_P(PSTR("\n----------------------------------------------------------------\n"));
+    RF24NetworkHeader inHeader;              //A header object is like the envelope of the message. It contains information 
+    uint16_t size = network.peek(inHeader);  //about the contents of the message so that we can know its type and size 
+                                             //before actually reading it
+    LOG_DEBUG("----------------------------------------------------------------\n");
     
+    byte payload[MAXMESSAGESIZE];
+    if (dispatch(inHeader, payload, size)) handledMessages++;
+    else discardedMessages++;
+    batch++;
+  }
   
+  if (batch > maxBatch) maxBatch = batch;
   
-    switch(inHeader.type)
-    {
-    
-      /////////////////////////////////////
-      ////Messages type A
-      ////The user has pressed * on the Key Tray Node and it has sent a notification to the Central Node to activate the alarm
-      /////////////////////////////////////
-      case 'A':
-      {
-        //The Key Tray Node receives automatic acknowledgement that this message has arrived. There is no need to manually send acknowledgement
-        network.read(inHeader,NULL,0);//Read the message. Even though it's empty we must take it out from the queue
-        printf_P(PSTR("Alarm Activated"));
-        Settings::setAlarmState(true);     
-        break;
-      }
-      
-      
-   
-      /////////////////////////////////////
-      ////Messages type B
-      ////The user has input a passcode (through numpad or RFID) in the Key Tray Node and it has been sent for confirmation
-      /////////////////////////////////////
-      case 'B':
-      {
-        byte receivedPasscode[PASSCODELENGTH];
-        
-        network.read(inHeader,&receivedPasscode,sizeof(receivedPasscode));
-       
-        printf_P(PSTR("Received passcode:\n  Passcode: "));
-        for(int i=0;i<PASSCODELENGTH;i++) printf_P(PSTR("%u "),receivedPasscode[i]);
-  
-        bool accessGranted = Settings::isPasscodeInDatabase(receivedPasscode);
-        if (accessGranted){
-          printf_P(PSTR("--> Valid passcode. Sending confirmation... "));
-          Settings::setAlarmState(false);
-        }
-        else printf_P(PSTR("--> Invalid passcode. Sending refusal... "));
-  
-        RF24NetworkHeader outHeader(inHeader.from_node, 'C'); //(to the same node, type)
-        if(network.write(outHeader, &accessGranted, sizeof(bool))) printf_P(PSTR("sent."));
-        break;
-      }
-      
-      
-      
-      /////////////////////////////////////
-      ////Messages type D
-      ////The user has input a NEW passcode (through numpad or RFID) in the Key Tray Node and it has been 
-      ////sent to be added to database
-      /////////////////////////////////////
-      case 'D':
-      {
-        byte receivedPasscode[PASSCODELENGTH];
-        
-        network.read(inHeader,&receivedPasscode,sizeof(receivedPasscode));
-       
-        printf("Received new passcode to add to database:\n  Passcode: ");
-        for(int i=0;i<PASSCODELENGTH;i++) printf("%u ",receivedPasscode[i]);
-  
-        Settings::addNewPasscode(receivedPasscode);
-        break;
-      }
-  
-  
-  
-      /////////////////////////////////////
-      ////Messages type E
-      ////A Movement Detector Node has been triggered and it has sent this alert
-      /////////////////////////////////////
-      case 'E':
-      {  
-        network.read(inHeader,0,0); //Read the message. Even though it's empty we must take it out from the queue
-        
-        printf_P(PSTR("   / \\\n"));
-        printf_P(PSTR("  / ! \\   A Movement Detector Node has been triggered!\n"));
-        printf_P(PSTR(" /_____\\\n\n"));
-        
-        if (!Settings::isAlarmActivated()) printf_P(PSTR("Since the alarm is deactivated no further action is required."));
-        else{
-          printf_P(PSTR("Sending alert to Buzzer Node..."));
-          RF24NetworkHeader outHeader(2, 'F'); //(receiver, type)
-          uint8_t retries = 0;
-          bool sent = false;
-          
-          while ((!sent)&&(retries<10)){
-            printf_P(PSTR("\nSending... "));
-            sent = network.write(outHeader,0,0);
-            if (sent) printf_P(PSTR("sent."));
-            else printf_P(PSTR("failure."));
-            retries++;
-          }    
-          if (!sent) printf_P(PSTR("\nMake sure the Buzzer Node is powered on and in range."));
-        }
-        break;
-      } 
-      
-      
-      
-      /////////////////////////////////////
-      ////Messages type G
-      ////A Window Node has been triggered and it has sent this alert
-      /////////////////////////////////////
-      case 'G':
-      {
-        network.read(inHeader,0,0); //Read the message. Even though it's empty we must take it out from the queue
-        
-        printf_P(PSTR("   / \\\n"));
-        printf_P(PSTR("  / ! \\   A Window Node has been triggered!\n"));
-        printf_P(PSTR(" /_____\\\n\n"));
-        
-        if (!Settings::isAlarmActivated()) printf_P(PSTR("Since the alarm is deactivated no further action is required."));
-        else{
-          printf_P(PSTR("Sending alert to Buzzer Node..."));
-          RF24NetworkHeader outHeader(2, 'F'); //(receiver, type)
-          uint8_t retries = 0;
-          bool sent = false;
-          
-          while ((!sent)&&(retries<10)){
-            printf_P(PSTR("\nSending... "));
-            sent = network.write(outHeader,0,0);
-            if (sent) printf_P(PSTR("sent."));
-            else printf_P(PSTR("failure."));
-            retries++;
-          }    
-          if (!sent) printf_P(PSTR("\nMake sure the Buzzer Node is powered on and in range."));
-        }
-        break;
-      }
-        
-        
-        
-        
-      /////////////////////////////////////
-      ////Messages of type unknown
-      /////////////////////////////////////
-      default:
-      {
-        network.read(inHeader,NULL,0);  //Remove message from queue
-        printf_P(PSTR("Careful! Another node has sent a message with a type that does not follow protocol. Revise its programming"));
-        break;
-      } 
-    
+  outbound.update();  //Send (or retry) messages to other nodes
+}
+
+
+
+/*
+Sets how much work a single call to update() may do: at most maxMessages messages, and no new message is started 
+once maxMicros microseconds have gone by. At least one message is always handled if there is any.
+*/
+void Communications::setWorkBudget(uint8_t maxMessages, unsigned long maxMicros)
+{
+  batchMessages = max(maxMessages, 1);
+  batchMicros = maxMicros;
+}
+
+
+
+//Sets how long after its last alert a sensor's alarm stays active. Alerts inside that time don't reach the sirens again
+void Communications::setAlertWindow(unsigned long milliseconds)
+{
+  coalescer.setWindow(milliseconds);
+  eventCoalescer.setWindow(milliseconds);
+}
+
+
+
+//Prints the message statistics in Serial console
+void Communications::printStats()
+{
+  printf_P(PSTR("\nMessages handled: %lu\n"),handledMessages);
+  printf_P(PSTR("Messages discarded: %lu\n"),discardedMessages);
+  printf_P(PSTR("Largest batch: %u (budget %u messages, %lu us)\n"),maxBatch,batchMessages,batchMicros);
+  printf_P(PSTR("Batches over budget: %lu\n"),budgetExhausted);
+  printf_P(PSTR("Radio FIFO full: %lu\n"),rxFifoFull);
+  printf_P(PSTR("Outbound messages pending: %u\n"),outbound.pending());
+  
+  for (int i=0; i<MAXSIRENNODES; i++){
+    if (sirenAlertStates[i] == DELIVERY_FREE) continue;
+    printf_P(PSTR("Last alert to siren %o: "),sirenAlertNodes[i]);
+    switch(sirenAlertStates[i]){
+      case DELIVERY_PENDING: printf_P(PSTR("pending\n")); break;
+      case DELIVERY_SENT: printf_P(PSTR("delivered\n")); break;
+      default: printf_P(PSTR("failed\n")); break;
     }
-    
   }
+  
+  coalescer.print();
+}
+
+
+
+//Sets all the message statistics back to 0
+void Communications::resetStats()
+{
+  handledMessages = 0;
+  discardedMessages = 0;
+  budgetExhausted = 0;
+  rxFifoFull = 0;
+  maxBatch = 0;
+  coalescer.resetCounters();
+}
 
+
+
+/*
+Reads the message at the front of the queue and passes it to the handler of its type. Messages of unknown types 
+and messages whose size doesn't match their type are taken out of the queue and discarded. Returns false for those.
+*/
+bool Communications::dispatch(RF24NetworkHeader& header, byte* payload, uint16_t size)
+{
+  MessageType route = {0, 0, NULL};
+  if ((header.type >= 'A') && (header.type <= 'Z')) memcpy_P(&route, &DISPATCHTABLE[header.type - 'A'], sizeof(route));
+  
+  if (route.type == 0){
+    network.read(header,NULL,0);  //Remove message from queue
+    LOG_WARNING("Careful! Node %o has sent a message of type %c, which does not follow protocol. Revise its programming\n",header.from_node,header.type);
+    return(false);
+  }
+  
+  if (size != route.payloadSize){
+    network.read(header,NULL,0);  //Remove message from queue
+    LOG_WARNING("Discarded message of type %c from node %o: %u bytes long instead of %u\n",header.type,header.from_node,size,route.payloadSize);
+    return(false);
+  }
+  
+  network.read(header,payload,route.payloadSize);  //Even if it's empty we must take it out from the queue
+  route.handler(*this, header, payload);
+  return(true);
 }
 
 
 
 
+/////////////////////////////////////
+////Messages type A
+////The user has pressed * on the Key Tray Node and it has sent a notification to the Central Node to activate the alarm
+/////////////////////////////////////
+void Communications::handleActivation(Communications& communications, RF24NetworkHeader& header, const byte* payload)
+{
+  //The Key Tray Node receives automatic acknowledgement that this message has arrived. There is no need to manually send acknowledgement
+  LOG_INFO("Alarm activated from node %o\n",header.from_node);
+  Settings::setAlarmState(true);     
+  EventLog::add(EVENT_ARMED, header.from_node);
+}
+
+
+
+/////////////////////////////////////
+////Messages type B
+////The user has input a passcode (through numpad or RFID) in the Key Tray Node and it has been sent for confirmation
+/////////////////////////////////////
+void Communications::handlePasscodeVerification(Communications& communications, RF24NetworkHeader& header, const byte* payload)
+{
+  byte receivedPasscode[PASSCODELENGTH];
+  memcpy(receivedPasscode, payload, PASSCODELENGTH);
+ 
+  LOG_DEBUG("Received passcode: %u %u %u %u %u %u\n",receivedPasscode[0],receivedPasscode[1],receivedPasscode[2],
+            receivedPasscode[3],receivedPasscode[4],receivedPasscode[5]);
+
+  bool accessGranted = Settings::isPasscodeInDatabase(receivedPasscode);
+  if (accessGranted){
+    LOG_INFO("Valid passcode from node %o. Alarm deactivated\n",header.from_node);
+    Settings::setAlarmState(false);
+    EventLog::add(EVENT_DISARMED, header.from_node);
+  }
+  else{
+    LOG_WARNING("Invalid passcode from node %o\n",header.from_node);
+    EventLog::add(EVENT_ACCESSDENIED, header.from_node);
+  }
+
+  if (communications.outbound.send(header.from_node, 'C', &accessGranted, sizeof(bool)) < 0){  //(to the same node, type...)
+    LOG_ERROR("Could not answer node %o: outbound queue full\n",header.from_node);
+  }
+}
+
+
+
+/////////////////////////////////////
+////Messages type D
+////The user has input a NEW passcode (through numpad or RFID) in the Key Tray Node and it has been 
+////sent to be added to database
+/////////////////////////////////////
+void Communications::handleNewPasscode(Communications& communications, RF24NetworkHeader& header, const byte* payload)
+{
+  byte receivedPasscode[PASSCODELENGTH];
+  memcpy(receivedPasscode, payload, PASSCODELENGTH);
+ 
+  LOG_DEBUG("Received new passcode to add to database: %u %u %u %u %u %u\n",receivedPasscode[0],receivedPasscode[1],
+            receivedPasscode[2],receivedPasscode[3],receivedPasscode[4],receivedPasscode[5]);
+
+  Settings::addNewPasscode(receivedPasscode);
+}
+
+
+
+/////////////////////////////////////
+////Messages type R
+////A sensor node has been powered on and announces itself. Payload: type of the alerts it sends (E or G) and zone
+/////////////////////////////////////
+void Communications::handleRegistration(Communications& communications, RF24NetworkHeader& header, const byte* payload)
+{
+  unsigned char type = payload[0];
+  uint8_t zone = payload[1];
+  
+  if (!SensorRegistry::isValidType(type)){
+    LOG_WARNING("Discarded registration of node %o: unknown type %u\n",header.from_node,type);
+    return;
+  }
+  
+  int sensor = SensorRegistry::registerSensor(header.from_node, type, zone);
+  if (sensor < 0){
+    LOG_ERROR("Could not register sensor node %o: registry full\n",header.from_node);
+    return;
+  }
+  SensorRegistry::seen(sensor);
+  LOG_INFO("Sensor node %o registered: type %c, zone %u\n",header.from_node,type,zone);
+}
+
+
+
+/////////////////////////////////////
+////Messages type H
+////Heartbeat: sent regularly by every node to show that it is still alive. Same payload as the registration
+/////////////////////////////////////
+void Communications::handleHeartbeat(Communications& communications, RF24NetworkHeader& header, const byte* payload)
+{
+  if (!SensorRegistry::isValidType(payload[0])){
+    LOG_WARNING("Discarded heartbeat of node %o: unknown type %u\n",header.from_node,payload[0]);
+    return;
+  }
+  
+  int node = SensorRegistry::registerSensor(header.from_node, payload[0], payload[1]);
+  if (node < 0){
+    LOG_ERROR("Could not supervise node %o: registry full\n",header.from_node);
+    return;
+  }
+  SensorRegistry::supervise(node);
+  SensorRegistry::seen(node);
+  LOG_DEBUG("Heartbeat from node %o\n",header.from_node);
+}
+
+
+
+/////////////////////////////////////
+////Messages type E and G
+////A Movement Detector Node (E) or a Window Node (G) has been triggered and it has sent this alert
+/////////////////////////////////////
+void Communications::handleSensorAlert(Communications& communications, RF24NetworkHeader& header, const byte* payload)
+{
+  int sensor = SensorRegistry::find(header.from_node);
+  if (sensor < 0) sensor = SensorRegistry::registerSensor(header.from_node, header.type, NOZONE);  //Unknown sensor
+  if (sensor >= 0) SensorRegistry::seen(sensor);
+  if (communications.eventCoalescer.trigger(header.from_node, header.type)) EventLog::add(EVENT_ALERT, header.from_node);  //Only the first of a series
+  
+  uint8_t zone = (sensor >= 0) ? SensorRegistry::getZone(sensor) : NOZONE;
+  
+  LOG_DEBUG("   / \\\n");
+  LOG_DEBUG("  / ! \\\n");
+  LOG_DEBUG(" /_____\\\n");
+  if (header.type == 'E') LOG_INFO("Movement Detector Node %o triggered (zone %u)\n",header.from_node,zone);
+  else LOG_INFO("Window Node %o triggered (zone %u)\n",header.from_node,zone);
+  
+  if (!Settings::isAlarmActivated()) LOG_DEBUG("Since the alarm is deactivated no further action is required.\n");
+  else if (!communications.coalescer.trigger(header.from_node, header.type)) LOG_DEBUG("The alarm of this node is still active. No new alert is needed.\n");
+  else communications.sendAlertToSirens();
+}
+
+
+
+/*
+Tells all the siren nodes to sound the alarm. The messages are queued together, so they are sent in the same pass, 
+and retried in the background if needed. Sirens that still have an alert waiting to be sent are skipped.
+*/
+void Communications::sendAlertToSirens()
+{
+  LOG_INFO("Sending alert to %u siren node(s)\n",Settings::getSirenCount());
+  
+  for (int i=0; i<Settings::getSirenCount(); i++){
+    uint16_t node = Settings::getSirenNode(i);
+    
+    if (outbound.isPending(node, 'F')){
+      LOG_DEBUG("An alert for siren %o is already waiting to be sent\n",node);
+      continue;
+    }
+    
+    int id = outbound.send(node, 'F', NULL, 0, &Communications::alertDelivered, this);
+    if (id < 0){
+      LOG_ERROR("Could not send alert to siren %o: outbound queue full\n",node);
+      continue;
+    }
+    sirenAlerts[i] = id;
+    sirenAlertStates[i] = DELIVERY_PENDING;
+    sirenAlertNodes[i] = node;
+  }
+}
+
+
+
+//Called by the outbound queue once an alert to a siren node has been delivered or given up. Its id is freed after this
+void Communications::alertDelivered(uint8_t id, bool delivered, void* context)
+{
+  Communications& communications = *(Communications*)context;
+  
+  for (int i=0; i<MAXSIRENNODES; i++){
+    if (communications.sirenAlerts[i] != id) continue;
+    communications.sirenAlerts[i] = -1;
+    communications.sirenAlertStates[i] = delivered ? DELIVERY_SENT : DELIVERY_FAILED;
+    uint16_t node = communications.sirenAlertNodes[i];
+    if (delivered) LOG_INFO("Alert delivered to siren %o\n",node);
+    else{
+      LOG_ERROR("Alert to siren %o failed after %u attempts. Make sure it is powered on and in range\n",node,MAXSENDATTEMPTS);
+      EventLog::add(EVENT_SIRENFAILED, node);
+    }
+    break;
+  }
+}
@@ -8,6 +8,28 @@
   - Send an alert to the Buzzer Node if the alarm is activated.
   - Modifying a setting.
   - etc.
+  
+  Each message type (a capital letter) has a handler method and a fixed payload size. They are listed once, in 
+  MESSAGETYPES in Communications.cpp, and a dispatch table indexed by the message type is built from that list at 
+  compile time and stored in flash. To support a new message type, write its handler and add a line to the list.
+  Messages whose payload doesn't have the expected size are discarded without being handled.
+  
+  Every call to update() handles all the messages waiting in the queue, so that a burst of alerts from several 
+  sensors is dealt with in a single pass instead of one message per pass. To keep the rest of the loop responsive, 
+  a batch stops after a maximum number of messages or a maximum time, whichever comes first (see setWorkBudget()). 
+  The remaining messages are left for the next pass. Statistics about the batches and the discarded messages can 
+  be printed with printStats().
+  
+  Messages to other nodes are not sent right away, but queued in an OutboundQueue that retries them in the 
+  following passes if the receiver doesn't answer. This way an unreachable Buzzer Node doesn't freeze the 
+  Central Node.
+  
+  Alerts go to every siren node in the list kept by Settings. The messages for all sirens are queued together and 
+  sent one after the other in the same pass, so all sirens start within one radio round-trip of each other. 
+  Whether each siren has received the last alert is tracked separately (see printStats()).
+  Repeated alerts from the same sensor are grouped by an AlertCoalescer, so only the first one of a series reaches 
+  the sirens. A second one does the same for the event log, whether the alarm is activated or not, so that a 
+  flapping sensor doesn't write an event to the EEPROM with every alert.
 */
 
 
@@ -16,8 +38,18 @@
 
 
 #include "Settings.h"
+#include "SensorRegistry.h"
+#include "EventLog.h"
+#include "Log.h"
 #include <RF24.h>
 #include <RF24Network.h>
+#include "OutboundQueue.h"
+#include "AlertCoalescer.h"
+
+
+const int MAXMESSAGESIZE = 32;  //Biggest payload accepted. Bigger ones are discarded
+const uint8_t DEFAULTBATCHMESSAGES = 8;  //Default work budget of each call to update()
+const unsigned long DEFAULTBATCHMICROS = 4000;
 
 
 
@@ -27,11 +59,62 @@ class Communications
     Communications();
     void begin();
     void update();
+    void setWorkBudget(uint8_t maxMessages, unsigned long maxMicros);
+    void setAlertWindow(unsigned long milliseconds);
+    void printStats();
+    void resetStats();
 
     
   private:
     RF24 radio;
     RF24Network network; 
+    OutboundQueue outbound;
+    
+    ////Work budget of each call to update()
+    uint8_t batchMessages;
+    unsigned long batchMicros;
+    
+    ////Statistics
+    unsigned long handledMessages;
+    unsigned long discardedMessages;  //Unknown type or wrong size
+    unsigned long budgetExhausted;  //Batches that had to leave messages in the queue
+    unsigned long rxFifoFull;  //Times the radio's own FIFO was found full. Further frames may have been lost
+    uint8_t maxBatch;  //Most messages handled in a single batch
+    
+    ////Message dispatch
+    typedef void (*MessageHandler)(Communications& communications, RF24NetworkHeader& header, const byte* payload);
+    
+    struct MessageType
+    {
+      unsigned char type;  //'A' to 'Z'. 0 for unused entries of the dispatch table
+      uint8_t payloadSize;
+      MessageHandler handler;
+    };
+    
+    static const MessageType MESSAGETYPES[];
+    static const int NUMMESSAGETYPES;
+    static const MessageType DISPATCHTABLE[];
+    static constexpr MessageType lookupType(unsigned char type, int index);
+    
+    bool dispatch(RF24NetworkHeader& header, byte* payload, uint16_t size);
+    
+    ////Handlers for each message type
+    static void handleActivation(Communications& communications, RF24NetworkHeader& header, const byte* payload);
+    static void handlePasscodeVerification(Communications& communications, RF24NetworkHeader& header, const byte* payload);
+    static void handleNewPasscode(Communications& communications, RF24NetworkHeader& header, const byte* payload);
+    static void handleHeartbeat(Communications& communications, RF24NetworkHeader& header, const byte* payload);
+    static void handleRegistration(Communications& communications, RF24NetworkHeader& header, const byte* payload);
+    static void handleSensorAlert(Communications& communications, RF24NetworkHeader& header, const byte* payload);
+    
+    ////Alerts to the siren nodes
+    AlertCoalescer coalescer;
+    AlertCoalescer eventCoalescer;  //Groups the alerts written to the event log
+    int8_t sirenAlerts[MAXSIRENNODES];  //Id in the outbound queue of the alert being sent to each siren. -1 if none
+    DeliveryState sirenAlertStates[MAXSIRENNODES];  //State of the last alert sent to each siren (the ids are reused)
+    uint16_t sirenAlertNodes[MAXSIRENNODES];  //Siren each of those alerts was sent to
+    
+    void sendAlertToSirens();
+    static void alertDelivered(uint8_t id, bool delivered, void* context);
 };
 
 
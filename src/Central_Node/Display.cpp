@@ -19,13 +19,16 @@ Display::Display() : lcd(8,7,6,5,4,3) //Initializer
 Prepares the lcd screen, creates special characters to draw big numbers, 
 and turns on the backlight.
 */
-void Display::Begin()
+void Display::Begin(TimerWheel& timerWheel)
 {
+  timers = &timerWheel;
+  
   prepareLCDCustomChars();
-  lcd.begin(20,4);
+  lcd.begin(LCDCOLUMNS,LCDROWS);
  
   pinMode(BACKLIGHTpin,OUTPUT);
   TurnBacklightOn();
+  timers->start(backlightTimer, BACKLIGHTTIME*1000UL, backlightTimeout, this);  //In 'Button Press' mode, the light goes off a few seconds after powering on
   
   DisplayLoadingScreen();  //Not really necessary, only provides visual cue of startup
 }
@@ -33,30 +36,55 @@ void Display::Begin()
 
 
 /*
-Creates special characters to draw big numbers
+Bitmaps (also called glyphs) of the special characters used to draw big numbers, for characters 1 to 8. They are
+kept in flash, and copied one at a time to the stack when they are sent to the LCD.
 ASCII art by mpilchfamily @ Instructables.com - http://www.instructables.com/id/Custom-Large-Font-For-16x2-lcds/
 */
+static const byte GLYPHS[8][8] PROGMEM = {
+  {B11111, B11111, B11111, B00000, B00000, B00000, B00000, B00000},  //1: Upper bar
+  {B11100, B11110, B11111, B11111, B11111, B11111, B11111, B11111},  //2: Right top corner
+  {B11111, B11111, B11111, B11111, B11111, B11111, B01111, B00111},  //3: Left low corner
+  {B00000, B00000, B00000, B00000, B00000, B11111, B11111, B11111},  //4: Lower bar
+  {B11111, B11111, B11111, B11111, B11111, B11111, B11110, B11100},  //5: Right low corner
+  {B11111, B11111, B11111, B00000, B00000, B00000, B11111, B11111},  //6: Upper and middle bars
+  {B11111, B00000, B00000, B00000, B00000, B11111, B11111, B11111},  //7: Middle and lower bars
+  {B00111, B01111, B11111, B11111, B11111, B11111, B11111, B11111}   //8: Left top corner
+};
+
+
+/*
+Characters that draw each big number (0-9) in a 3x2 block: the three of the top row, then the three of the bottom
+row. 1-8 are the glyphs above, and 255 is a full block.
+*/
+static const byte BIGDIGITS[10][6] PROGMEM = {
+  {8, 1, 2,      3, 4, 5},        //0
+  {1, 2, ' ',    ' ', 255, ' '},  //1
+  {6, 6, 2,      3, 7, 7},        //2
+  {6, 6, 2,      7, 7, 5},        //3
+  {3, 4, 2,      ' ', ' ', 255},  //4
+  {255, 6, 6,    7, 7, 5},        //5
+  {8, 6, 6,      3, 7, 5},        //6
+  {1, 1, 2,      ' ', 8, ' '},    //7
+  {8, 6, 2,      3, 7, 5},        //8
+  {8, 6, 2,      ' ', ' ', 255}   //9
+};
+
+
+//Abbreviated names of the months, 3 characters each
+static const char MONTHNAMES[] PROGMEM = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+
+
+//Creates the special characters to draw big numbers
 void Display::prepareLCDCustomChars()
 {
-  //Create bitmaps (also called glyphs) for drawing big numbers
-  byte LT[8] = {B00111, B01111, B11111, B11111, B11111, B11111, B11111, B11111};
-  byte UB[8] = {B11111, B11111, B11111, B00000, B00000, B00000, B00000, B00000};
-  byte RT[8] = {B11100, B11110, B11111, B11111, B11111, B11111, B11111, B11111};
-  byte LL[8] = {B11111, B11111, B11111, B11111, B11111, B11111, B01111, B00111};
-  byte LB[8] = {B00000, B00000, B00000, B00000, B00000, B11111, B11111, B11111};
-  byte LR[8] = {B11111, B11111, B11111, B11111, B11111, B11111, B11110, B11100};
-  byte UMB[8] = {B11111, B11111, B11111, B00000, B00000, B00000, B11111, B11111};
-  byte LMB[8] = {B11111, B00000, B00000, B00000, B00000, B11111, B11111, B11111};
-
+  byte glyph[8];
+  
   //Register the bitmaps as characters for the lcd (each with a given index)
-  lcd.createChar(1,UB);
-  lcd.createChar(2,RT);
-  lcd.createChar(3,LL);
-  lcd.createChar(4,LB);
-  lcd.createChar(5,LR);
-  lcd.createChar(6,UMB);
-  lcd.createChar(7,LMB);
-  lcd.createChar(8,LT);
+  for (int i = 0; i < 8; i++){
+    memcpy_P(glyph, GLYPHS[i], sizeof(glyph));
+    lcd.createChar(i+1, glyph);
+  }
 }
 
 
@@ -69,20 +97,21 @@ However it gives the user a useful visual cue.
 void Display::DisplayLoadingScreen()
 {  
   lcd.clear();
-  lcd.print("       LOADING");
+  lcd.print(F("       LOADING"));
   
   lcd.setCursor(0,1);
-  lcd.print("--------------------");
+  lcd.print(F("--------------------"));
   lcd.setCursor(0,3);
-  lcd.print("--------------------");
+  lcd.print(F("--------------------"));
   
   lcd.setCursor(0,2);
   for(int i=0;i<20;i++){
-    lcd.print("|");
+    lcd.print('|');
     delay(50);  
   }
   delay(400);
   lcd.clear();
+  screen.screenCleared();
 }
 
 
@@ -92,61 +121,20 @@ void Display::DisplayLoadingScreen()
   which subscreen to display, where to draw the cursor, etc.
   StateMachine.h contains the backend logic behind the finite state machine used to navigate the different menus. 
   Display.h is the just the frontend. It checks the current state of the FSM and draws the corresponding screen.
+  Screens are drawn into a shadow framebuffer (see LCDBuffer.h) and only the characters that changed reach the LCD.
 */
-void Display::update(StateMachine stateMachine, AnalogKeyboard analogKeyboard, RTC_DS1307 Clock)
+void Display::update(const StateMachine& stateMachine, ClockService& Clock)
 {  
-  updateBacklight(analogKeyboard); //Do we need to turn on or off the LCD backlight?
-  cleanScreen(stateMachine);
-  
-  switch(stateMachine.GetState()){
-    
-    case 0:
-      displayMainScreen(Clock); 
-      break;
-         
-    case 1:
-       displayMenuRoot(stateMachine);
-       break;
+  //Every screen is drawn from scratch into the frame buffer, so there is no need to clear the LCD when the 
+  //user moves to another screen. Only the characters that end up different are sent to the LCD.
+  screen.clear();
   
-    case 2:
-      displayTimeSelectionScreen(stateMachine);
-      break;
+  //Draw the screen of the current state (see Menu.cpp)
+  MenuEntry menu;
+  Menu::get(stateMachine.GetState(), menu);
+  (this->*menu.render)(stateMachine, Clock);
   
-    case 3:
-      displayDateSelectionScreen(stateMachine);
-      break;
-      
-    case 4:
-      displayAddPasscodeScreen();
-      break;
-      
-    case 5:
-      displayDeletePasscodeScreen(stateMachine);
-      break;
-     
-    case 6:
-      displayChangeBacklightModeScreen(stateMachine);
-      break;
-      
-    case 7:
-      displayFactoryResetScreen(stateMachine);
-  }
-}
-
-
-/*
-Clears the screen. The screen can't be cleared continuously since it makes the screen flicker. Instead, 
-it is cleaned whenever the user accedes to a new subbmenu.
-*/
-void Display::cleanScreen(StateMachine stateMachine)
-{
-  static int previousState = stateMachine.GetState();
-  static int previousCursorPosition = stateMachine.GetCursorPosition();
-  
-  if ((previousState != stateMachine.GetState()) || (previousCursorPosition != stateMachine.GetCursorPosition())) lcd.clear();
-  
-  previousState = stateMachine.GetState();
-  previousCursorPosition = stateMachine.GetCursorPosition();
+  screen.flush(lcd);
 }
 
 
@@ -155,23 +143,29 @@ void Display::cleanScreen(StateMachine stateMachine)
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //Display the main screen with clock, date, alarm state...
-void Display::displayMainScreen(RTC_DS1307 Clock)
+void Display::displayMainScreen(const StateMachine&, ClockService& Clock)
 { 
   displayTime(Clock);
   displayDate(Clock);
   
   //Display alarm state
-  lcd.setCursor(15,1);
-  lcd.print("ALARM");
-  lcd.setCursor(16,2);
-  if(Settings::isAlarmActivated()) lcd.print("ON ");
-  else lcd.print("OFF");
+  screen.setCursor(15,1);
+  screen.print(F("ALARM"));
+  screen.setCursor(16,2);
+  if(Settings::isAlarmActivated()) screen.print(F("ON "));
+  else screen.print(F("OFF"));
+  
+  //Warn if a node has stopped sending heartbeats
+  if(SensorRegistry::getLostCount() > 0){
+    screen.setCursor(16,3);
+    screen.print(F("LOST"));
+  }
 }
 
 
 
 //Display the clock portion of the main screen
-void Display::displayTime(RTC_DS1307 Clock)
+void Display::displayTime(ClockService& Clock)
 {
   DateTime now = Clock.now();
  
@@ -182,9 +176,9 @@ void Display::displayTime(RTC_DS1307 Clock)
   displayBigNumber(now.minute() / 10, 2);
   displayBigNumber(now.minute() % 10, 3);
   
-  lcd.setCursor(11,2);
-  lcd.print(now.second()/10);
-  lcd.print(now.second()%10);
+  screen.setCursor(11,2);
+  screen.print(now.second()/10);
+  screen.print(now.second()%10);
 }
 
 
@@ -198,51 +192,13 @@ void Display::displayBigNumber(int num, int pos)
   int x = pos*3;
   if (x>=6) x++;
    
+  if ((num < 0) || (num > 9)) return;
+  
   //Draw the whole number with previously created bitmaps 
-  switch (num){
-    case 0:
-      lcd.setCursor(x, 0); lcd.write(8); lcd.write(1); lcd.write(2); lcd.setCursor(x, 1); lcd.write(3); lcd.write(4); lcd.write(5);
-      break;
-      
-    case 1:
-      lcd.setCursor(x,0); lcd.write(1); lcd.write(2); lcd.write(' '); lcd.setCursor(x,1); lcd.write(' '); lcd.write(255); lcd.write(' ');
-      break;
-      
-    case 2:
-      lcd.setCursor(x,0); lcd.write(6); lcd.write(6); lcd.write(2); lcd.setCursor(x, 1); lcd.write(3); lcd.write(7); lcd.write(7);
-      break;
-      
-    case 3:
-      lcd.setCursor(x,0); lcd.write(6); lcd.write(6); lcd.write(2); lcd.setCursor(x, 1); lcd.write(7); lcd.write(7); lcd.write(5); 
-      break;
-      
-    case 4:
-      lcd.setCursor(x,0); lcd.write(3); lcd.write(4); lcd.write(2); lcd.setCursor(x, 1); lcd.write(' '); lcd.write(' '); lcd.write(255);
-      break;
-      
-    case 5:
-      lcd.setCursor(x,0); lcd.write(255); lcd.write(6); lcd.write(6); lcd.setCursor(x, 1); lcd.write(7); lcd.write(7); lcd.write(5);
-      break;
-      
-    case 6:
-      lcd.setCursor(x,0); lcd.write(8); lcd.write(6); lcd.write(6); lcd.setCursor(x, 1); lcd.write(3); lcd.write(7); lcd.write(5);
-      break;
-      
-    case 7:
-      lcd.setCursor(x,0); lcd.write(1); lcd.write(1); lcd.write(2); lcd.setCursor(x, 1); lcd.write(' '); lcd.write(8); lcd.write(' ');
-      break;
-      
-    case 8:
-      lcd.setCursor(x,0); lcd.write(8); lcd.write(6); lcd.write(2); lcd.setCursor(x, 1); lcd.write(3); lcd.write(7); lcd.write(5);
-      break;
-      
-    case 9:
-      lcd.setCursor(x,0); lcd.write(8); lcd.write(6); lcd.write(2); lcd.setCursor(x, 1); lcd.write(' '); lcd.write(' '); lcd.write(255);
-      break;
-      
-    default:
-      break;   
-  }    
+  for (int row = 0; row < 2; row++){
+    screen.setCursor(x, row);
+    for (int col = 0; col < 3; col++) screen.write(pgm_read_byte(&BIGDIGITS[num][row*3 + col]));
+  }
 }
 
 
@@ -250,10 +206,10 @@ void Display::displayBigNumber(int num, int pos)
 //Display the colon between hours and minutes
 void Display::displayColon()
 {
-  lcd.setCursor(6,0);
-  lcd.write(B10100101);
-  lcd.setCursor(6,1);
-  lcd.write(B10100101);
+  screen.setCursor(6,0);
+  screen.write(B10100101);
+  screen.setCursor(6,1);
+  screen.write(B10100101);
 }
 
 
@@ -261,30 +217,29 @@ void Display::displayColon()
 //Display a blank space between hours and minutes
 void Display::displaySpace()
 {
-  lcd.setCursor(6,0);
-  lcd.write(' ');
-  lcd.setCursor(6,1);
-  lcd.write(' ');
+  screen.setCursor(6,0);
+  screen.write(' ');
+  screen.setCursor(6,1);
+  screen.write(' ');
 }
 
 
 
 //Display the full date on the bottom row (Example: 12 May'15)
-void Display::displayDate(RTC_DS1307 clock)
+void Display::displayDate(ClockService& clock)
 {
   DateTime now = clock.now();
   
-  lcd.setCursor(0,4);
-  if(now.day()<10) lcd.print('0');  //Pad with a zero if necessary
-  lcd.print(now.day());
+  screen.setCursor(0,4);
+  if(now.day()<10) screen.print('0');  //Pad with a zero if necessary
+  screen.print(now.day());
   
-  const char* month[]={"Jan","Feb","Mar","Apr","May","Jun","Jul","Aug","Sep","Oct","Nov","Dec"};
-  lcd.print(' ');
-  lcd.print(month[now.month()-1]);
+  screen.print(' ');
+  for (int i = 0; i < 3; i++) screen.write(pgm_read_byte(&MONTHNAMES[(now.month()-1)*3 + i]));
   
-  lcd.print(" '");
-  if(now.year()%100<10) lcd.print('0');
-  lcd.print(now.year()%100);
+  screen.print(F(" '"));
+  if(now.year()%100<10) screen.print('0');
+  screen.print(now.year()%100);
 }
 
 
@@ -294,120 +249,124 @@ void Display::displayDate(RTC_DS1307 clock)
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //Display root menu with the list of possible settings to change 
-void Display::displayMenuRoot(StateMachine stateMachine)
+void Display::displayMenuRoot(const StateMachine& stateMachine, ClockService&)
 {  
-  const char* MenuItems[] = {"Change Time", "Change Date", "Add passcode", "Delete passcode", "Change LCD light", "Reset settings"};
-  
   //Print title on first line
-  lcd.setCursor(0,0);
-  lcd.print("______Main Menu_____");
+  screen.setCursor(0,0);
+  screen.print(F("______Main Menu_____"));
   
   //Print three entries
   if(stateMachine.GetCursorPosition()>0){
-    lcd.setCursor(1,1);
-    lcd.print(MenuItems[stateMachine.GetCursorPosition()-1]);
-    lcd.setCursor(19,1);
-    lcd.write(94);  //Arrow up
+    screen.setCursor(1,1);
+    screen.print(Menu::getLabel(MENU_FIRSTLISTED + stateMachine.GetCursorPosition()-1));
+    screen.setCursor(19,1);
+    screen.write(94);  //Arrow up
   }
   
-  lcd.setCursor(0,2);
-  lcd.write(161);  //Display the cursor
-  lcd.print(MenuItems[stateMachine.GetCursorPosition()]);
+  screen.setCursor(0,2);
+  screen.write(161);  //Display the cursor
+  screen.print(Menu::getLabel(MENU_FIRSTLISTED + stateMachine.GetCursorPosition()));
  
-  if(stateMachine.GetCursorPosition()<5){
-    lcd.setCursor(1,3);
-    lcd.print(MenuItems[stateMachine.GetCursorPosition()+1]);
-    lcd.setCursor(19,3);
-    lcd.print('v');  //Arrow down
+  if(stateMachine.GetCursorPosition()<NUMLISTEDMENUS-1){
+    screen.setCursor(1,3);
+    screen.print(Menu::getLabel(MENU_FIRSTLISTED + stateMachine.GetCursorPosition()+1));
+    screen.setCursor(19,3);
+    screen.print('v');  //Arrow down
   }
 }
 
 
 
 //Displays the screen to change time
-void Display::displayTimeSelectionScreen(StateMachine stateMachine)
+void Display::displayTimeSelectionScreen(const StateMachine& stateMachine, ClockService&)
 {  
-  lcd.setCursor(0,0);
-  lcd.print("_____Change time____");
-  lcd.setCursor(1,2);
-  if(stateMachine.tempHour<10) lcd.print('0');
-  lcd.print(stateMachine.tempHour);
-  lcd.print(" : ");
-  if(stateMachine.tempMinute<10) lcd.print('0');
-  lcd.print(stateMachine.tempMinute);
-  lcd.print("    OK BACK");
-
-  if(stateMachine.GetCursorPosition()==0) lcd.setCursor(1,3);
-  else if(stateMachine.GetCursorPosition()==1) lcd.setCursor(6,3);
-  else if(stateMachine.GetCursorPosition()==2) lcd.setCursor(12,3);
-  else if(stateMachine.GetCursorPosition()==3) lcd.setCursor(16,3);
-  lcd.print("--");
+  screen.setCursor(0,0);
+  screen.print(F("_____Change time____"));
+  screen.setCursor(1,2);
+  if(stateMachine.tempHour<10) screen.print('0');
+  screen.print(stateMachine.tempHour);
+  screen.print(F(" : "));
+  if(stateMachine.tempMinute<10) screen.print('0');
+  screen.print(stateMachine.tempMinute);
+  screen.print(F("    OK BACK"));
+
+  if(stateMachine.GetCursorPosition()==0) screen.setCursor(1,3);
+  else if(stateMachine.GetCursorPosition()==1) screen.setCursor(6,3);
+  else if(stateMachine.GetCursorPosition()==2) screen.setCursor(12,3);
+  else if(stateMachine.GetCursorPosition()==3) screen.setCursor(16,3);
+  screen.print(F("--"));
 }
 
 
 
 //Displays the screen to change date
-void Display::displayDateSelectionScreen(StateMachine stateMachine)
+void Display::displayDateSelectionScreen(const StateMachine& stateMachine, ClockService&)
 {  
-  lcd.setCursor(0,0);
-  lcd.print("_____Change date____");
-  lcd.setCursor(1,2);
-  if(stateMachine.tempDay<10) lcd.print('0');
-  lcd.print(stateMachine.tempDay);
-  lcd.print("/");
-  if(stateMachine.tempMonth<10) lcd.print('0');
-  lcd.print(stateMachine.tempMonth);
-  lcd.print("/");
-  if(stateMachine.tempYear<10) lcd.print('0');
-  lcd.print(stateMachine.tempYear);
+  screen.setCursor(0,0);
+  screen.print(F("_____Change date____"));
+  screen.setCursor(1,2);
+  if(stateMachine.tempDay<10) screen.print('0');
+  screen.print(stateMachine.tempDay);
+  screen.print('/');
+  if(stateMachine.tempMonth<10) screen.print('0');
+  screen.print(stateMachine.tempMonth);
+  screen.print('/');
+  if(stateMachine.tempYear<10) screen.print('0');
+  screen.print(stateMachine.tempYear);
   
-  lcd.print(" OK BACK");
-
-  if(stateMachine.GetCursorPosition()==0) lcd.setCursor(1,3);
-  else if(stateMachine.GetCursorPosition()==1) lcd.setCursor(4,3);
-  else if(stateMachine.GetCursorPosition()==2) lcd.setCursor(8,3);
-  else if(stateMachine.GetCursorPosition()==3) lcd.setCursor(12,3);
-  else if(stateMachine.GetCursorPosition()==4) lcd.setCursor(16,3);
-  lcd.print("--");
+  screen.print(F(" OK BACK"));
+
+  if(stateMachine.GetCursorPosition()==0) screen.setCursor(1,3);
+  else if(stateMachine.GetCursorPosition()==1) screen.setCursor(4,3);
+  else if(stateMachine.GetCursorPosition()==2) screen.setCursor(8,3);
+  else if(stateMachine.GetCursorPosition()==3) screen.setCursor(12,3);
+  else if(stateMachine.GetCursorPosition()==4) screen.setCursor(16,3);
+  screen.print(F("--"));
 }
 
 
 
 //Display screen with instructions to add a new passcode or RFID tag
-void Display::displayAddPasscodeScreen()
+void Display::displayAddPasscodeScreen(const StateMachine&, ClockService&)
 {
-  lcd.setCursor(0,0); lcd.print("With alarm off press");
-  lcd.setCursor(0,1); lcd.print(" # on Key Tray Node");
-  lcd.setCursor(0,2); lcd.print("and enter new pass-");
-  lcd.setCursor(0,3); lcd.print("code/RFID tag."); 
+  screen.setCursor(0,0); screen.print(F("With alarm off press"));
+  screen.setCursor(0,1); screen.print(F(" # on Key Tray Node"));
+  screen.setCursor(0,2); screen.print(F("and enter new pass-"));
+  screen.setCursor(0,3); screen.print(F("code/RFID tag.")); 
 }
 
 
 
 //Display a menu to let the user select one of the stored passcodes to be deleted 
-void Display::displayDeletePasscodeScreen(StateMachine stateMachine)
+void Display::displayDeletePasscodeScreen(const StateMachine& stateMachine, ClockService&)
 {
   //Print title on first line
-  lcd.setCursor(0,0);
-  lcd.print("Delete passcode/RFID");
+  screen.setCursor(0,0);
+  screen.print(F("Delete passcode/RFID"));
+  
+  if(Settings::getStoredPasscodeCount() == 0){
+    screen.setCursor(1,2);
+    screen.print(F("No passcodes"));
+    return;
+  }
   
   //Print three entries
   if(stateMachine.GetCursorPosition()>0){
-    lcd.setCursor(1,1);
+    screen.setCursor(1,1);
     displayPasscode(stateMachine.GetCursorPosition()-1);
-    lcd.setCursor(19,1);
-    lcd.write(94);  //Arrow up
+    screen.setCursor(19,1);
+    screen.write(94);  //Arrow up
   }
   
-  lcd.setCursor(0,2);
-  lcd.write(161);  //Display the cursor
+  screen.setCursor(0,2);
+  screen.write(161);  //Display the cursor
   displayPasscode(stateMachine.GetCursorPosition());
  
-  if(stateMachine.GetCursorPosition()<10){
-    lcd.setCursor(1,3);
+  if(stateMachine.GetCursorPosition()<Settings::getStoredPasscodeCount()-1){
+    screen.setCursor(1,3);
     displayPasscode(stateMachine.GetCursorPosition()+1);
-    lcd.setCursor(19,3);
-    lcd.print('v');  //Arrow down
+    screen.setCursor(19,3);
+    screen.print('v');  //Arrow down
   }
   
 }
@@ -420,51 +379,51 @@ void Display::displayPasscode(int index)
   byte* passcode = Settings::getStoredPasscode(index);
      
   for(int i=0; i<PASSCODELENGTH; i++){
-    lcd.print(passcode[i]);
-    lcd.print(' ');
+    screen.print(passcode[i]);
+    screen.print(' ');
   }   
 }
 
 
 
 //Display the menu to let the user change the backlight mode
-void Display::displayChangeBacklightModeScreen(StateMachine stateMachine)
+void Display::displayChangeBacklightModeScreen(const StateMachine& stateMachine, ClockService&)
 {
   //Display title on first line
-  lcd.setCursor(0,0);
-  lcd.print("___Backlight mode___");
+  screen.setCursor(0,0);
+  screen.print(F("___Backlight mode___"));
   
   //Display the two options
-  lcd.setCursor(1,1);
-  lcd.print("Always on");
-  lcd.setCursor(1,2);
-  lcd.print("On button press");
-  lcd.setCursor(1,3);
-  lcd.print("Always off");
+  screen.setCursor(1,1);
+  screen.print(F("Always on"));
+  screen.setCursor(1,2);
+  screen.print(F("On button press"));
+  screen.setCursor(1,3);
+  screen.print(F("Always off"));
   
   //Display the cursor
-  lcd.setCursor(0, stateMachine.GetCursorPosition() + 1) ;
-  lcd.write(161);
+  screen.setCursor(0, stateMachine.GetCursorPosition() + 1) ;
+  screen.write(161);
 }
 
 
 
-void Display::displayFactoryResetScreen(StateMachine stateMachine)
+void Display::displayFactoryResetScreen(const StateMachine& stateMachine, ClockService&)
 {
-  lcd.setCursor(0,0);
-  lcd.print("Restore all settings");
-  lcd.setCursor(0,1);
-  lcd.print("to factory default?");
-  lcd.setCursor(1,2);
-  lcd.print("    NO     YES");
+  screen.setCursor(0,0);
+  screen.print(F("Restore all settings"));
+  screen.setCursor(0,1);
+  screen.print(F("to factory default?"));
+  screen.setCursor(1,2);
+  screen.print(F("    NO     YES"));
   
   if(stateMachine.GetCursorPosition()==0){
-    lcd.setCursor(5,3);
-    lcd.print("--");
+    screen.setCursor(5,3);
+    screen.print(F("--"));
   }
   else if(stateMachine.GetCursorPosition()==1){
-    lcd.setCursor(12,3);
-    lcd.print("---");
+    screen.setCursor(12,3);
+    screen.print(F("---"));
   }
 }
 
@@ -478,14 +437,10 @@ void Display::displayFactoryResetScreen(StateMachine stateMachine)
 
 /*
 Turns on the LCD backlight whenever a key is pressed, and turns it off after a set time after 
-the last key was pressed
+the last key was pressed. It must be called right after every AnalogKeyboard::update(), or key presses will be missed.
 */
-void Display::updateBacklight(AnalogKeyboard analogKeyboard)
+void Display::updateBacklight(const AnalogKeyboard& analogKeyboard)
 {
-  static long lastInputTime = 0;
-  static bool startupLightOn = true;
-  
-  
   ////MODE 'ALWAYS ON'
   if (Settings::getBacklightMode() == 0)
   {
@@ -500,26 +455,12 @@ void Display::updateBacklight(AnalogKeyboard analogKeyboard)
   ////MODE 'ON BUTTON PRESS'
   if (Settings::getBacklightMode() == 1)  //Do the following only if backlight is not set on Always ON mode
   {  
-    //Turn it on if a button was pressed (only in 'Button Press' mode)
+    //Turn it on if a button was pressed, and turn it off after a few seconds with no button presses (see backlightTimeout())
     if (analogKeyboard.wasAnyButtonPressed())
     {  
       TurnBacklightOn();
-      lastInputTime = millis();
-    }
-    
-    //Turn it off after a few seconds with no button presses (only in 'Button Press' mode)
-    if (backlightOn && (millis()-lastInputTime>BACKLIGHTTIME*1000))
-    {  
-      TurnBacklightOff();
+      timers->start(backlightTimer, BACKLIGHTTIME*1000UL, backlightTimeout, this);
     }
-    
-    //This part turns off the light a few seconds after powering on the Arduino (only in 'Button Press' mode)
-    //(it's a bit confusing but works)
-    if (startupLightOn && millis()>BACKLIGHTTIME*1000)
-    {
-      if(!backlightOn)digitalWrite(BACKLIGHTpin,LOW);
-      startupLightOn = false;
-    }    
   }
   
   
@@ -535,6 +476,15 @@ void Display::updateBacklight(AnalogKeyboard analogKeyboard)
 
 
 
+//Called by the backlight timer when there have been no button presses for a few seconds
+void Display::backlightTimeout(void* context)
+{
+  Display* display = (Display*)context;
+  if (Settings::getBacklightMode() == 1) display->TurnBacklightOff();
+}
+
+
+
 //Turns backlight on and updates the variable that tracks its state
 void Display::TurnBacklightOn()
 {
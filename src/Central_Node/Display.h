@@ -14,9 +14,13 @@
 
 #include "Arduino.h"
 #include "Settings.h"
-#include <RTClib.h>
+#include "SensorRegistry.h"  //To warn about lost nodes
+#include "ClockService.h"
 #include "StateMachine.h"
+#include "Menu.h"
 #include <LiquidCrystal.h>
+#include "LCDBuffer.h"
+#include <TimerWheel.h>
 
 
 class Display
@@ -24,40 +28,45 @@ class Display
   public:
   
     Display();
-    void Begin();
-    void update(StateMachine, AnalogKeyboard, RTC_DS1307);
+    void Begin(TimerWheel& timerWheel);
+    void update(const StateMachine& stateMachine, ClockService& Clock);
+    void updateBacklight(const AnalogKeyboard& analogKeyboard);
     void TurnBacklightOn();
     void TurnBacklightOff();
     
     
   private:
   
+    friend class Menu;  //The menu table points to the methods that draw each screen
+  
     LiquidCrystal lcd;
+    LCDBuffer screen;  //Screens are drawn here, and then only the changes are sent to lcd
     bool backlightOn;
+    TimerWheel* timers;
+    Timer backlightTimer;  //Turns the backlight off a while after the last key press (only in 'Button Press' mode)
+    
+    static void backlightTimeout(void* context);
     
     void DisplayLoadingScreen();
     
     void prepareLCDCustomChars();
-    void cleanScreen(StateMachine stateMachine);
     
-    void displayMainScreen(RTC_DS1307 Clock);
-    void displayTime(RTC_DS1307 Clock);
+    void displayMainScreen(const StateMachine& stateMachine, ClockService& Clock);
+    void displayTime(ClockService& Clock);
     void displayBigNumber(int num, int pos);
     void displayColon();
     void displaySpace();
-    void displayDate(RTC_DS1307 Clock);
+    void displayDate(ClockService& Clock);
     
-    void displayMenuRoot(StateMachine stateMachine);
+    void displayMenuRoot(const StateMachine& stateMachine, ClockService& Clock);
     
-    void displayTimeSelectionScreen(StateMachine stateMachine);
-    void displayDateSelectionScreen(StateMachine stateMachine);
-    void displayAddPasscodeScreen();
-    void displayDeletePasscodeScreen(StateMachine stateMachine);
+    void displayTimeSelectionScreen(const StateMachine& stateMachine, ClockService& Clock);
+    void displayDateSelectionScreen(const StateMachine& stateMachine, ClockService& Clock);
+    void displayAddPasscodeScreen(const StateMachine& stateMachine, ClockService& Clock);
+    void displayDeletePasscodeScreen(const StateMachine& stateMachine, ClockService& Clock);
     void displayPasscode(int index);
-    void displayChangeBacklightModeScreen(StateMachine stateMachine);
-    void displayFactoryResetScreen(StateMachine stateMachine);
-    
-    void updateBacklight(AnalogKeyboard analogKeyboard);
+    void displayChangeBacklightModeScreen(const StateMachine& stateMachine, ClockService& Clock);
+    void displayFactoryResetScreen(const StateMachine& stateMachine, ClockService& Clock);
 };
 
 
@@ -0,0 +1,103 @@
+#include "EEPROMQueue.h"
+
+
+EEPROMQueue::PendingWrite EEPROMQueue::queue[EEPROMQUEUESIZE];
+uint8_t EEPROMQueue::head = 0;
+uint8_t EEPROMQueue::count = 0;
+
+
+
+//Schedules a write of one byte to the EEPROM. Returns immediately unless the queue is full
+void EEPROMQueue::write(int address, byte value)
+{
+  int position = findPending(address);
+  if (position >= 0) removePending(position);  //Already pending: replaced by this write, at the end of the queue
+  
+  if (count == EEPROMQUEUESIZE) writeOldest();  //Make room
+  
+  PendingWrite& pendingWrite = queue[(head + count) % EEPROMQUEUESIZE];
+  pendingWrite.address = address;
+  pendingWrite.value = value;
+  count++;
+}
+
+
+
+//Reads one byte, taking into account the writes that are still pending
+byte EEPROMQueue::read(int address)
+{
+  int position = findPending(address);
+  if (position >= 0) return(queue[position].value);
+  return(EEPROM.read(address));
+}
+
+
+
+/*
+Must be called regularly. Writes the oldest pending byte, but only if the EEPROM is ready, so it never blocks. 
+Returns true if a byte was written.
+*/
+bool EEPROMQueue::update()
+{
+  if (count == 0) return(false);
+  
+#if defined(__AVR__)
+  if (!eeprom_is_ready()) return(false);  //The previous write is still in progress
+#endif
+  
+  writeOldest();
+  return(true);
+}
+
+
+
+//Writes all pending bytes, waiting for each one to finish
+void EEPROMQueue::flush()
+{
+  while (count > 0) writeOldest();
+}
+
+
+
+//Returns the number of writes that have not reached the EEPROM yet
+int EEPROMQueue::pending()
+{
+  return(count);
+}
+
+
+
+//Returns the position in the ring buffer of the pending write for the given address, or -1 if there is none
+int EEPROMQueue::findPending(int address)
+{
+  for (uint8_t i = 0; i < count; i++){
+    uint8_t position = (head + i) % EEPROMQUEUESIZE;
+    if (queue[position].address == address) return(position);
+  }
+  return(-1);
+}
+
+
+
+//Takes a pending write out of the queue, moving the newer ones one position back
+void EEPROMQueue::removePending(uint8_t position)
+{
+  uint8_t tail = (head + count - 1) % EEPROMQUEUESIZE;
+  while (position != tail){
+    uint8_t next = (position + 1) % EEPROMQUEUESIZE;
+    queue[position] = queue[next];
+    position = next;
+  }
+  count--;
+}
+
+
+
+//Takes the oldest write out of the queue and sends it to the EEPROM. The byte is only rewritten if it has changed
+void EEPROMQueue::writeOldest()
+{
+  PendingWrite& pendingWrite = queue[head];
+  EEPROM.update(pendingWrite.address, pendingWrite.value);
+  head = (head + 1) % EEPROMQUEUESIZE;
+  count--;
+}
@@ -0,0 +1,60 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This library has been made for the final project of my career, an Arduino Smart Alarm. You may reuse all or part 
+  of the included code freely for non-commercial purposes.
+  
+  Queue of pending EEPROM writes. Writing a byte to the ATmega's EEPROM takes about 3.3 ms, and the EEPROM library 
+  blocks until the previous write has finished. Writing a passcode (6 bytes) would therefore stop the main loop for 
+  20 ms, and radio messages would wait meanwhile. Instead, writes are stored in RAM and update() writes one byte 
+  each time it is called, only if the EEPROM has finished the previous one, so it never has to wait.
+   - read() returns the value that will end up in the EEPROM, so pending writes are already visible.
+   - A second write to an address that is still pending replaces the first one, and moves to the end of the queue, 
+     so writes always reach the EEPROM in the order they were made (EventLog relies on it).
+   - Bytes that already hold the value being written are not rewritten (like EEPROM.update()). This is checked 
+     when the write reaches the EEPROM, since reading the EEPROM also has to wait for a write in progress.
+   - If the queue is full, the oldest write is done right away (blocking), so no write is ever lost.
+   - flush() writes everything that is pending. Use it before powering down or resetting.
+  It uses static methods, so it is not necessary to create an instance.
+*/
+
+#ifndef EEQueue_h
+#define EEQueue_h
+
+
+#include "Arduino.h"
+#include <EEPROM.h>
+
+
+const int EEPROMQUEUESIZE = 64;
+
+
+class EEPROMQueue
+{
+  public:
+  
+    static void write(int address, byte value);
+    static byte read(int address);
+    static bool update();
+    static void flush();
+    static int pending();
+    
+    
+  private:
+  
+    struct PendingWrite
+    {
+      uint16_t address;
+      byte value;
+    };
+    
+    static PendingWrite queue[EEPROMQUEUESIZE];  //Ring buffer, oldest write first
+    static uint8_t head;  //Position of the oldest write
+    static uint8_t count;
+    
+    static int findPending(int address);
+    static void removePending(uint8_t position);
+    static void writeOldest();
+};
+
+
+#endif
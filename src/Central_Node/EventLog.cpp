@@ -0,0 +1,228 @@
+#include "EventLog.h"
+
+
+//Permanent storage layout: a ring of EVENTLOGSIZE records, each with a sequence number (2 bytes), the event and a check byte
+const int EVENTRECORDSIZE = 11;
+const int EVENTLOGADDRESS = 2048;  //Only if the log is in the internal EEPROM (the default). It takes up to 2751
+const uint16_t ERASEDEVENTSEQUENCE = 0xFFFF;  //What an erased EEPROM reads as. Never used as a sequence number
+const unsigned long SAVEINTERVAL = 100;  //Milliseconds between events copied to storage, so that the EEPROMQueue never fills up
+
+const char EVENTNAME_POWERON[] PROGMEM = "Power on";
+const char EVENTNAME_ALERT[] PROGMEM = "Alert";
+const char EVENTNAME_ARMED[] PROGMEM = "Armed";
+const char EVENTNAME_DISARMED[] PROGMEM = "Disarmed";
+const char EVENTNAME_ACCESSDENIED[] PROGMEM = "Access denied";
+const char EVENTNAME_SIRENFAILED[] PROGMEM = "Siren unreachable";
+const char EVENTNAME_NODELOST[] PROGMEM = "Node lost";
+const char EVENTNAME_NODEBACK[] PROGMEM = "Node back";
+
+const char* const EVENTNAMES[NUMEVENTTYPES] PROGMEM = {EVENTNAME_POWERON, EVENTNAME_ALERT, EVENTNAME_ARMED, 
+                                                       EVENTNAME_DISARMED, EVENTNAME_ACCESSDENIED, EVENTNAME_SIRENFAILED,
+                                                       EVENTNAME_NODELOST, EVENTNAME_NODEBACK};
+
+EEPROMStorage eventLogEEPROM;
+
+static_assert(EVENTLOGSIZE <= 255, "Positions in the log are stored in a byte");
+
+EventLog::Event EventLog::events[EVENTLOGSIZE];
+uint8_t EventLog::head;
+uint8_t EventLog::count;
+uint8_t EventLog::unsaved;
+int EventLog::savedNewest;
+uint16_t EventLog::savedSequence;
+int EventLog::dumpPosition = -1;
+ClockService* EventLog::clock = NULL;
+unsigned long EventLog::lastSave;
+StorageBackend* EventLog::storage = &eventLogEEPROM;
+unsigned long EventLog::storageAddress = EVENTLOGADDRESS;
+
+
+
+//Moves the log to another storage, starting at the given address. Must be called before begin()
+void EventLog::setStorage(StorageBackend& newStorage, unsigned long address)
+{
+  storage = &newStorage;
+  storageAddress = address;
+}
+
+
+
+/*
+Loads the log from permanent storage. Must be called once at startup.
+The newest record is the last one of the run of consecutive sequence numbers. From there, the ring is walked 
+backwards for as long as the sequence numbers keep going down by one.
+*/
+void EventLog::begin()
+{
+  head = 0;
+  count = 0;
+  unsaved = 0;
+  savedNewest = -1;
+  
+  //Find the newest record
+  Event event;
+  uint16_t sequence;
+  for (int position=0; position<EVENTLOGSIZE; position++){
+    if (!readRecord(position, event, sequence)) continue;
+    
+    Event next;
+    uint16_t nextNumber;
+    bool nextFollows = readRecord((position+1) % EVENTLOGSIZE, next, nextNumber) && (nextNumber == nextSequence(sequence));
+    if (!nextFollows){
+      savedNewest = position;
+      savedSequence = sequence;
+      break;
+    }
+  }
+  if (savedNewest < 0) return;  //Nothing has been logged yet
+  
+  //Count the records that lead to it, and load them oldest first
+  uint16_t expected = savedSequence;
+  while (count < EVENTLOGSIZE){
+    int position = (savedNewest - count + EVENTLOGSIZE) % EVENTLOGSIZE;
+    if (!readRecord(position, event, sequence) || (sequence != expected)) break;
+    count++;
+    expected = (expected == 0) ? ERASEDEVENTSEQUENCE - 1 : expected - 1;
+  }
+  
+  for (int i=0; i<count; i++){
+    readRecord((savedNewest - count + 1 + i + EVENTLOGSIZE) % EVENTLOGSIZE, events[i], sequence);
+  }
+  head = count % EVENTLOGSIZE;
+}
+
+
+
+//Sets where the time of the events comes from
+void EventLog::setClock(ClockService& myClock)
+{
+  clock = &myClock;
+}
+
+
+
+//Adds an event to the log, overwriting the oldest one if the log is full
+void EventLog::add(EventType type, uint16_t node)
+{
+  Event& event = events[head];
+  event.time = now();
+  event.node = node;
+  event.type = type;
+  event.armed = Settings::isAlarmActivated();
+  
+  head = (head + 1) % EVENTLOGSIZE;
+  if (count < EVENTLOGSIZE) count++;
+  if (unsaved < EVENTLOGSIZE) unsaved++;
+}
+
+
+
+//Must be called regularly. Copies one new event to permanent storage and prints one event of a dump in progress
+void EventLog::update()
+{
+  if (unsaved && (millis() - lastSave >= SAVEINTERVAL)){
+    saveOldestUnsaved();
+    lastSave = millis();
+  }
+  
+  if (dumpPosition >= 0){
+    if (dumpPosition < count){
+      printEvent(events[(head + EVENTLOGSIZE - count + dumpPosition) % EVENTLOGSIZE]);
+      dumpPosition++;
+    }
+    else{
+      printf_P(PSTR("%u events\n"),count);
+      dumpPosition = -1;
+    }
+  }
+}
+
+
+
+//Starts printing the log over Serial, oldest event first. The events are printed by update()
+void EventLog::startDump()
+{
+  printf_P(PSTR("\nDate        Time      Node   Alarm  Event\n"));
+  dumpPosition = 0;
+}
+
+
+
+//Returns how many events are in the log
+int EventLog::getCount()
+{
+  return(count);
+}
+
+
+
+//Current Unix time (0 until there is a clock)
+uint32_t EventLog::now()
+{
+  if (clock == NULL) return(0);
+  return(clock->unixtime());
+}
+
+
+
+/*
+Copies the oldest event not yet saved to permanent storage, as the record after the newest one. Its position in 
+storage doesn't have to match its position in RAM: if unsaved events were overwritten, the stored ring simply 
+doesn't have them, and the sequence numbers go on without a gap.
+*/
+void EventLog::saveOldestUnsaved()
+{
+  uint8_t position = (head + EVENTLOGSIZE - unsaved) % EVENTLOGSIZE;
+  unsaved--;
+  
+  savedSequence = (savedNewest < 0) ? 0 : nextSequence(savedSequence);
+  savedNewest = (savedNewest + 1) % EVENTLOGSIZE;
+  
+  byte record[EVENTRECORDSIZE];
+  record[0] = lowByte(savedSequence);
+  record[1] = highByte(savedSequence);
+  memcpy(&record[2], &events[position], sizeof(Event));
+  record[EVENTRECORDSIZE-1] = 0xA5;  //So that an erased record (all 0xFF) or a zeroed one never passes
+  for (int i=0; i<EVENTRECORDSIZE-1; i++) record[EVENTRECORDSIZE-1] ^= record[i];
+  
+  storage->writeBlock(storageAddress + savedNewest*EVENTRECORDSIZE, record, sizeof(record));
+}
+
+
+
+//Reads the record at the given position of the stored ring. Returns false if it is erased or corrupt
+bool EventLog::readRecord(int position, Event& event, uint16_t& sequence)
+{
+  byte record[EVENTRECORDSIZE];
+  storage->readBlock(storageAddress + position*EVENTRECORDSIZE, record, sizeof(record));
+  
+  byte check = 0xA5;
+  for (int i=0; i<EVENTRECORDSIZE-1; i++) check ^= record[i];
+  
+  sequence = word(record[1], record[0]);
+  memcpy(&event, &record[2], sizeof(Event));
+  return((sequence != ERASEDEVENTSEQUENCE) && (record[EVENTRECORDSIZE-1] == check));
+}
+
+
+
+//Sequence numbers wrap around, skipping the one used to mark erased records
+uint16_t EventLog::nextSequence(uint16_t sequence)
+{
+  sequence++;
+  if (sequence == ERASEDEVENTSEQUENCE) sequence = 0;
+  return(sequence);
+}
+
+
+
+//Prints one event in Serial console
+void EventLog::printEvent(const Event& event)
+{
+  DateTime time(event.time);
+  char name[20];
+  strcpy_P(name, (const char*)pgm_read_ptr(&EVENTNAMES[event.type < NUMEVENTTYPES ? event.type : 0]));
+  
+  printf_P(PSTR("%04u/%02u/%02u  %02u:%02u:%02u  %-5o  %-5s  %s\n"),time.year(),time.month(),time.day(),
+           time.hour(),time.minute(),time.second(),event.node,event.armed ? "ON" : "OFF",name);
+}
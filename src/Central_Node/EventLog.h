@@ -0,0 +1,97 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This library has been made for the final project of my career, an Arduino Smart Alarm. You may reuse all or part 
+  of the included code freely for non-commercial purposes.
+  
+  Log of the events of the alarm system (alerts, arming, disarming...), so that there is a record of what happened 
+  even if no computer was listening to the Serial port. The latest EVENTLOGSIZE events are kept in RAM in a ring 
+  buffer of packed 8-byte records, each one with:
+   - Time (Unix time), taken from the ClockService.
+   - Node that caused the event.
+   - Type of event (see EventType).
+   - Whether the alarm was activated at that moment.
+  Adding an event only copies 8 bytes into the ring: the time comes from the ClockService given to setClock(), 
+  which doesn't read the clock over I2C for it. 
+  update() copies new events to permanent storage in the background, one at a time, so that the log survives a 
+  reset. By default the log is stored in the internal EEPROM, from address 2048. There is no header to rewrite 
+  with every event: like the SettingsLog, the stored log is a ring of records with a sequence number and a check 
+  byte, so each event is written to a different place, and begin() finds the newest one by looking for the 
+  break in the sequence.
+  startDump() prints the whole log over Serial, also one event per call of update(), so the loop never stops for it.
+  Like Settings, it uses static methods, so it is not necessary to create an instance.
+*/
+
+#ifndef EventLog_h
+#define EventLog_h
+
+
+#include "Arduino.h"
+#include "ClockService.h"
+#include "Settings.h"  //To know whether the alarm is activated
+#include "StorageBackend.h"
+
+
+const int EVENTLOGSIZE = 64;  //Events kept. The oldest ones are overwritten
+
+
+enum EventType
+{
+  EVENT_POWERON,
+  EVENT_ALERT,
+  EVENT_ARMED,
+  EVENT_DISARMED,
+  EVENT_ACCESSDENIED,
+  EVENT_SIRENFAILED,
+  EVENT_NODELOST,
+  EVENT_NODEBACK,
+  NUMEVENTTYPES
+};
+
+
+class EventLog
+{
+  public:
+  
+    static void setStorage(StorageBackend& storage, unsigned long address);
+    static void begin();
+    static void setClock(ClockService& clock);
+    static void add(EventType type, uint16_t node);
+    static void update();
+    static void startDump();
+    static int getCount();
+    
+    
+  private:
+  
+    struct Event
+    {
+      uint32_t time;
+      uint16_t node;
+      uint8_t type;
+      uint8_t armed;
+    };
+    static_assert(sizeof(Event) == 8, "Events are stored as packed 8-byte records");
+    
+    static Event events[EVENTLOGSIZE];
+    static uint8_t head;  //Position where the next event will be written
+    static uint8_t count;
+    static uint8_t unsaved;  //Newest events not yet copied to permanent storage
+    static int savedNewest;  //Position in storage of the newest record. -1 if there is none
+    static uint16_t savedSequence;  //Its sequence number
+    static int dumpPosition;  //Events already printed by the dump in progress. -1 if there is none
+    
+    static ClockService* clock;
+    static unsigned long lastSave;
+    
+    static StorageBackend* storage;
+    static unsigned long storageAddress;
+    
+    static uint32_t now();
+    static void saveOldestUnsaved();
+    static bool readRecord(int position, Event& event, uint16_t& sequence);
+    static uint16_t nextSequence(uint16_t sequence);
+    static void printEvent(const Event& event);
+};
+
+
+#endif
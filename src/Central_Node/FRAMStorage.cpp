@@ -0,0 +1,132 @@
+#include "FRAMStorage.h"
+
+
+//SPI FRAM opcodes
+const byte FRAM_WREN = 0x06;  //Write enable
+const byte FRAM_WRITE = 0x02;
+const byte FRAM_READ = 0x03;
+
+
+//Constructor. mySize is the capacity of the chip in bytes (e.g. 8192 for an MB85RS64)
+FRAMStorage::FRAMStorage(uint8_t myCSpin, unsigned long mySize)
+{
+  CSpin = myCSpin;
+  capacity = mySize;
+  pageAddress = 0;
+  dirty = 0;
+}
+
+
+
+//Prepares the Chip Select pin and the SPI bus
+void FRAMStorage::begin()
+{
+  pinMode(CSpin, OUTPUT);
+  digitalWrite(CSpin, HIGH);
+  SPI.begin();
+}
+
+
+
+byte FRAMStorage::read(unsigned long address)
+{
+  byte value;
+  readBlock(address, &value, 1);
+  return(value);
+}
+
+
+
+//Reads several bytes in a single SPI transaction, then applies the writes still pending in the page buffer
+void FRAMStorage::readBlock(unsigned long address, byte* data, unsigned int length)
+{
+  startCommand(FRAM_READ, address);
+  for (unsigned int i = 0; i < length; i++) data[i] = SPI.transfer(0);
+  endCommand();
+  
+  for (uint8_t i = 0; i < FRAMPAGESIZE; i++){
+    unsigned long pending = pageAddress + i;
+    if ((dirty & (1UL << i)) && (pending >= address) && (pending < address + length)) data[pending - address] = page[i];
+  }
+}
+
+
+
+//Stores the write in the page buffer. If it belongs to another page, the current page is written to the chip first
+void FRAMStorage::write(unsigned long address, byte value)
+{
+  unsigned long base = address - (address % FRAMPAGESIZE);
+  if (base != pageAddress){
+    flush();
+    pageAddress = base;
+  }
+  
+  page[address - base] = value;
+  dirty |= (1UL << (address - base));
+}
+
+
+
+//Writes the pending bytes in the background
+void FRAMStorage::update()
+{
+  flush();
+}
+
+
+
+//Writes the pending bytes of the page buffer, one SPI transaction for each run of consecutive bytes
+void FRAMStorage::flush()
+{
+  uint8_t i = 0;
+  while (dirty){
+    if (!(dirty & (1UL << i))){
+      i++;
+      continue;
+    }
+    
+    //Write enable is cleared by the chip after every write, so it has to be sent before each one
+    startCommand(FRAM_WREN, 0);
+    endCommand();
+    
+    startCommand(FRAM_WRITE, pageAddress + i);
+    while ((i < FRAMPAGESIZE) && (dirty & (1UL << i))){
+      SPI.transfer(page[i]);
+      dirty &= ~(1UL << i);
+      i++;
+    }
+    endCommand();
+  }
+}
+
+
+
+unsigned long FRAMStorage::size()
+{
+  return(capacity);
+}
+
+
+
+//Selects the chip and sends an opcode. READ and WRITE are followed by the address: 2 bytes for chips up to 
+//64 KB, 3 bytes for bigger ones
+void FRAMStorage::startCommand(byte command, unsigned long address)
+{
+  SPI.beginTransaction(SPISettings(8000000, MSBFIRST, SPI_MODE0));
+  digitalWrite(CSpin, LOW);
+  SPI.transfer(command);
+  
+  if ((command == FRAM_READ) || (command == FRAM_WRITE)){
+    if (capacity > 65536) SPI.transfer((address >> 16) & 0xFF);
+    SPI.transfer((address >> 8) & 0xFF);
+    SPI.transfer(address & 0xFF);
+  }
+}
+
+
+
+void FRAMStorage::endCommand()
+{
+  digitalWrite(CSpin, HIGH);
+  SPI.endTransaction();
+}
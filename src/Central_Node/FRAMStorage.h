@@ -0,0 +1,58 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This library has been made for the final project of my career, an Arduino Smart Alarm. You may reuse all or part 
+  of the included code freely for non-commercial purposes.
+  
+  Storage backend for an external SPI FRAM chip (Fujitsu MB85RS or Cypress FM25 series, for example). FRAM is 
+  written at the speed of the SPI bus, with no waiting and practically no wear, so it is a good place for large 
+  passcode databases and event histories. It shares the SPI bus with the nRF24l01+; only its Chip Select pin differs.
+  
+  Writes are batched: they are collected in a RAM copy of one 32-byte page, and each run of consecutive changed 
+  bytes is sent in a single SPI transaction (one command and address for the whole run) when the writes move to 
+  another page, when update() is called, or on flush().
+  
+  Note: SPI flash chips are not supported by this class, since they need a whole sector erased before rewriting.
+*/
+
+#ifndef FRAMStor_h
+#define FRAMStor_h
+
+
+#include "Arduino.h"
+#include <SPI.h>
+#include "StorageBackend.h"
+
+
+const int FRAMPAGESIZE = 32;
+
+
+class FRAMStorage : public StorageBackend
+{
+  public:
+  
+    FRAMStorage(uint8_t myCSpin, unsigned long mySize);
+    void begin();
+    
+    virtual byte read(unsigned long address);
+    virtual void write(unsigned long address, byte value);
+    virtual void readBlock(unsigned long address, byte* data, unsigned int length);
+    virtual void update();
+    virtual void flush();
+    virtual unsigned long size();
+    
+    
+  private:
+  
+    uint8_t CSpin;
+    unsigned long capacity;  //In bytes
+    
+    byte page[FRAMPAGESIZE];  //Pending writes
+    unsigned long pageAddress;  //Address of the first byte of page
+    uint32_t dirty;  //Bit n set: page[n] has to be written
+    
+    void startCommand(byte command, unsigned long address);
+    void endCommand();
+};
+
+
+#endif
@@ -0,0 +1,75 @@
+#include "LCDBuffer.h"
+
+
+//Constructor. Both buffers start blank, which is what the LCD shows after lcd.begin()
+LCDBuffer::LCDBuffer()
+{
+  clear();
+  screenCleared();
+}
+
+
+
+//Blanks the frame being drawn. Nothing is sent to the LCD until flush() is called
+void LCDBuffer::clear()
+{
+  memset(frame, ' ', sizeof(frame));
+  cursorCol = 0;
+  cursorRow = 0;
+}
+
+
+
+//Moves the drawing position. Like LiquidCrystal, rows beyond the last one are clamped to the last one
+void LCDBuffer::setCursor(uint8_t col, uint8_t row)
+{
+  if (row >= LCDROWS) row = LCDROWS - 1;
+  cursorCol = col;
+  cursorRow = row;
+}
+
+
+
+//Draws a character at the current position and advances it. Characters past the end of the row are dropped
+size_t LCDBuffer::write(uint8_t character)
+{
+  if (cursorCol < LCDCOLUMNS) frame[cursorRow][cursorCol] = character;
+  cursorCol++;
+  return(1);
+}
+
+
+
+/*
+Sends to the LCD only the characters that differ from what it is already showing. The LCD's cursor advances by
+itself after each character, so setCursor() is only sent when there is a gap between two changed characters.
+Returns the number of characters sent.
+*/
+uint8_t LCDBuffer::flush(LiquidCrystal& lcd)
+{
+  uint8_t sent = 0;
+  
+  for (uint8_t row = 0; row < LCDROWS; row++){
+    int8_t lcdCol = -1;  //Where the LCD's cursor is in this row (-1: somewhere else)
+    
+    for (uint8_t col = 0; col < LCDCOLUMNS; col++){
+      if (frame[row][col] == shown[row][col]) continue;
+      
+      if (lcdCol != col) lcd.setCursor(col, row);
+      lcd.write(frame[row][col]);
+      shown[row][col] = frame[row][col];
+      lcdCol = col + 1;
+      sent++;
+    }
+  }
+  
+  return(sent);
+}
+
+
+
+//Must be called after clearing the LCD by other means (e.g. lcd.clear()), so that the buffer knows it is blank
+void LCDBuffer::screenCleared()
+{
+  memset(shown, ' ', sizeof(shown));
+}
@@ -0,0 +1,49 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This library has been made for the final project of my career, an Arduino Smart Alarm. You may reuse all or part 
+  of the included code freely for non-commercial purposes.
+  
+  Shadow framebuffer for a 4x20 HD44780 LCD. Screens are drawn into a RAM copy of the display (it behaves like 
+  LiquidCrystal: setCursor(), print(), write()...), and flush() then compares it with what the LCD is known to show 
+  and sends only the characters that changed. Every command sent to the LCD blocks the loop for tens of microseconds, 
+  while most of the screen stays the same from one frame to the next, so this saves most of the bus time.
+*/
+
+#ifndef LCDBuff_h
+#define LCDBuff_h
+
+
+#include "Arduino.h"
+#include <LiquidCrystal.h>
+
+
+const int LCDCOLUMNS = 20;
+const int LCDROWS = 4;
+
+
+class LCDBuffer : public Print
+{
+  public:
+  
+    LCDBuffer();
+    
+    void clear();
+    void setCursor(uint8_t col, uint8_t row);
+    virtual size_t write(uint8_t character);
+    using Print::write;
+    
+    uint8_t flush(LiquidCrystal& lcd);
+    void screenCleared();
+    
+    
+  private:
+  
+    byte frame[LCDROWS][LCDCOLUMNS];  //What we want the LCD to show
+    byte shown[LCDROWS][LCDCOLUMNS];  //What the LCD is showing right now
+    
+    uint8_t cursorCol;
+    uint8_t cursorRow;
+};
+
+
+#endif
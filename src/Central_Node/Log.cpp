@@ -0,0 +1,70 @@
+#include "Log.h"
+
+
+char Log::buffer[LOGBUFFERSIZE];
+uint16_t Log::head;
+uint16_t Log::count;
+unsigned long Log::lostBytes;
+
+
+
+//Formats a message (format in flash, like printf_P()) and adds it to the buffer. Use the LOG_* macros instead
+void Log::print_P(const char* format, ...)
+{
+  char line[LOGLINESIZE];
+  va_list arguments;
+  va_start(arguments, format);
+  vsnprintf_P(line, sizeof(line), format, arguments);
+  va_end(arguments);
+  
+  for (char* c = line; *c; c++){
+    if (count == LOGBUFFERSIZE){
+      lostBytes++;
+      continue;
+    }
+    buffer[(head + count) % LOGBUFFERSIZE] = *c;
+    count++;
+  }
+}
+
+
+
+//Must be called regularly. Sends as much buffered text as fits in the Serial transmit buffer, without waiting
+void Log::update()
+{
+  int room = Serial.availableForWrite();
+  while (count && (room > 0)){
+    Serial.write(buffer[head]);
+    head = (head + 1) % LOGBUFFERSIZE;
+    count--;
+    room--;
+  }
+}
+
+
+
+//Sends all the buffered text, waiting for the Serial port if needed. For debugging output that must not be mixed
+void Log::flush()
+{
+  while (count){
+    Serial.write(buffer[head]);
+    head = (head + 1) % LOGBUFFERSIZE;
+    count--;
+  }
+}
+
+
+
+//Returns how many bytes of text have been lost because the buffer was full
+unsigned long Log::getLostBytes()
+{
+  return(lostBytes);
+}
+
+
+
+//Sets the count of lost bytes back to 0
+void Log::resetLostBytes()
+{
+  lostBytes = 0;
+}
@@ -0,0 +1,85 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This library has been made for the final project of my career, an Arduino Smart Alarm. You may reuse all or part 
+  of the included code freely for non-commercial purposes.
+  
+  Logging with severity levels and buffered output. At 57600 baud the Serial port sends about 6 characters per 
+  millisecond, and once its 64-byte transmit buffer is full, printf() waits until there is room again. A banner 
+  printed when an alert arrives could stop the loop for 20 ms. Instead, the LOG_* macros below copy the formatted 
+  text into a RAM buffer, and update() (called on every pass of the loop) moves to the Serial port only as much as 
+  fits in its transmit buffer without waiting. From there the Serial interrupt sends it. If the buffer overflows, 
+  the text that doesn't fit is lost (and counted), but the loop never waits.
+  
+  Messages have a severity, from LOG_ERROR to LOG_DEBUG. Only those with a severity up to LOG_LEVEL are compiled; 
+  the rest compile to nothing, so they cost neither time nor flash. Define LOG_LEVEL before this file is included 
+  to change it. The format strings are kept in flash, as with printf_P().
+*/
+
+#ifndef Log_h
+#define Log_h
+
+
+#include "Arduino.h"
+
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO  //Debug messages (banners and other details) are left out
+#endif
+
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(format, ...) Log::print_P(PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_ERROR(format, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARNING
+#define LOG_WARNING(format, ...) Log::print_P(PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_WARNING(format, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(format, ...) Log::print_P(PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_INFO(format, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(format, ...) Log::print_P(PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(format, ...) do {} while (0)
+#endif
+
+
+const int LOGBUFFERSIZE = 256;  //Bytes
+const int LOGLINESIZE = 96;  //Longest text a single LOG_* call can produce
+
+
+class Log
+{
+  public:
+  
+    static void print_P(const char* format, ...);
+    static void update();
+    static void flush();
+    static unsigned long getLostBytes();
+    static void resetLostBytes();
+    
+    
+  private:
+  
+    static char buffer[LOGBUFFERSIZE];  //Ring buffer of text waiting to be sent
+    static uint16_t head;  //Position of the oldest byte
+    static uint16_t count;
+    static unsigned long lostBytes;
+};
+
+
+#endif
@@ -0,0 +1,99 @@
+#include "LoopProfiler.h"
+
+
+//Names of the stages, in the same order as the LoopStage enum
+const char STAGENAME_COMMUNICATIONS[] PROGMEM = "Communications";
+const char STAGENAME_KEYBOARD[] PROGMEM = "AnalogKeyboard";
+const char STAGENAME_STATEMACHINE[] PROGMEM = "StateMachine";
+const char STAGENAME_DISPLAY[] PROGMEM = "Display";
+
+const char* const STAGENAMES[NUMSTAGES] PROGMEM = {STAGENAME_COMMUNICATIONS, STAGENAME_KEYBOARD, 
+                                                   STAGENAME_STATEMACHINE, STAGENAME_DISPLAY};
+
+
+
+//Constructor
+LoopProfiler::LoopProfiler()
+{
+  reset();
+  startTime = 0;
+}
+
+
+
+//Call right before the code to be measured
+void LoopProfiler::startStage()
+{
+  startTime = micros();
+}
+
+
+
+//Call right after the code to be measured. Adds the time since startStage() to the statistics of the given stage
+void LoopProfiler::endStage(LoopStage stage)
+{
+  unsigned long duration = micros() - startTime;
+  StageStats& s = stats[stage];
+  
+  s.count++;
+  s.total += duration;
+  if (duration < s.min) s.min = duration;
+  if (duration > s.max) s.max = duration;
+  
+  s.histogram[bucketFor(duration)]++;
+}
+
+
+
+//Returns the histogram bucket for a duration: 0 for 0 us, 1 for 1 us, 2 for 2-3 us, 3 for 4-7 us...
+uint8_t LoopProfiler::bucketFor(unsigned long duration)
+{
+  uint8_t bucket = 0;
+  while (duration && (bucket < HISTOGRAMBUCKETS-1)){
+    duration >>= 1;
+    bucket++;
+  }
+  return(bucket);
+}
+
+
+
+//Prints the statistics of every stage over Serial
+void LoopProfiler::print()
+{
+  char name[16];
+  
+  printf_P(PSTR("\n--------------------LOOP PROFILE (us)--------------------\n"));
+  for (uint8_t i = 0; i < NUMSTAGES; i++){
+    StageStats& s = stats[i];
+    strcpy_P(name, (const char*)pgm_read_ptr(&STAGENAMES[i]));
+    
+    if (s.count == 0){
+      printf_P(PSTR("%s: no samples\n"), name);
+      continue;
+    }
+    printf_P(PSTR("%s: count %lu  min %lu  mean %lu  max %lu\n"), name, s.count, s.min, 
+             (unsigned long)(s.total / s.count), s.max);
+    
+    for (uint8_t b = 0; b < HISTOGRAMBUCKETS; b++){
+      if (s.histogram[b] == 0) continue;
+      unsigned long low = b ? (1UL << (b-1)) : 0;
+      if (b == HISTOGRAMBUCKETS-1) printf_P(PSTR("  %6lu+        %lu\n"), low, (unsigned long)s.histogram[b]);
+      else printf_P(PSTR("  %6lu-%-6lu  %lu\n"), low, b ? (1UL << b) - 1 : 0, (unsigned long)s.histogram[b]);
+    }
+  }
+}
+
+
+
+//Forgets all the samples taken so far
+void LoopProfiler::reset()
+{
+  for (uint8_t i = 0; i < NUMSTAGES; i++){
+    stats[i].count = 0;
+    stats[i].min = 0xFFFFFFFF;
+    stats[i].max = 0;
+    stats[i].total = 0;
+    for (uint8_t b = 0; b < HISTOGRAMBUCKETS; b++) stats[i].histogram[b] = 0;
+  }
+}
@@ -0,0 +1,63 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This library has been made for the final project of my career, an Arduino Smart Alarm. You may reuse all or part 
+  of the included code freely for non-commercial purposes.
+  
+  Measures how long each stage of the Central Node's main loop takes (radio, keyboard, menus and LCD), to find out 
+  where the time goes when an alert is handled late. For every stage it keeps the minimum, maximum and mean duration 
+  and a histogram with logarithmic buckets (bucket n counts durations from 2^(n-1) to 2^n - 1 microseconds). 
+  Everything lives in fixed-size arrays, so measuring costs two calls to micros() and no memory allocation.
+  The results are printed over Serial with print().
+*/
+
+#ifndef LoopProf_h
+#define LoopProf_h
+
+
+#include "Arduino.h"
+
+
+enum LoopStage
+{
+  STAGE_COMMUNICATIONS,
+  STAGE_KEYBOARD,
+  STAGE_STATEMACHINE,
+  STAGE_DISPLAY,
+  NUMSTAGES
+};
+
+const int HISTOGRAMBUCKETS = 16;  //The last bucket also holds everything longer than 16 ms
+
+
+class LoopProfiler
+{
+  public:
+  
+    LoopProfiler();
+    
+    void startStage();
+    void endStage(LoopStage stage);
+    
+    void print();
+    void reset();
+    
+    
+  private:
+  
+    struct StageStats
+    {
+      unsigned long count;
+      unsigned long min;
+      unsigned long max;
+      uint64_t total;
+      uint32_t histogram[HISTOGRAMBUCKETS];  //The radio stage alone takes tens of thousands of samples per second
+    };
+    
+    StageStats stats[NUMSTAGES];
+    unsigned long startTime;
+    
+    static uint8_t bucketFor(unsigned long duration);
+};
+
+
+#endif
@@ -0,0 +1,44 @@
+#include "Menu.h"
+#include "StateMachine.h"
+#include "Display.h"
+
+
+////Labels of the menus listed in the Root Menu
+static const char LABELTIME[] PROGMEM = "Change Time";
+static const char LABELDATE[] PROGMEM = "Change Date";
+static const char LABELADDPASSCODE[] PROGMEM = "Add passcode";
+static const char LABELDELETEPASSCODE[] PROGMEM = "Delete passcode";
+static const char LABELBACKLIGHT[] PROGMEM = "Change LCD light";
+static const char LABELFACTORYRESET[] PROGMEM = "Reset settings";
+
+
+////The menus, in the order of MenuState. Arguments: {label, cursor keys, last cursor position, enter, input, render}
+const MenuEntry Menu::ENTRIES[NUMMENUS] PROGMEM = {
+  {NULL, CURSOR_NONE, 0, nullptr, &StateMachine::inputMainScreen, &Display::displayMainScreen},  //MENU_MAIN
+  {NULL, CURSOR_VERTICAL, NUMLISTEDMENUS-1, nullptr, &StateMachine::inputMenuRoot, &Display::displayMenuRoot},  //MENU_ROOT
+  {LABELTIME, CURSOR_HORIZONTAL, 3, &StateMachine::enterTimeSelection, &StateMachine::inputTimeSelection, &Display::displayTimeSelectionScreen},  //MENU_TIME
+  {LABELDATE, CURSOR_HORIZONTAL, 4, &StateMachine::enterDateSelection, &StateMachine::inputDateSelection, &Display::displayDateSelectionScreen},  //MENU_DATE
+  {LABELADDPASSCODE, CURSOR_NONE, 0, nullptr, &StateMachine::inputAddPasscode, &Display::displayAddPasscodeScreen},  //MENU_ADDPASSCODE
+  {LABELDELETEPASSCODE, CURSOR_VERTICAL, CURSOR_PASSCODES, nullptr, &StateMachine::inputDeletePasscode, &Display::displayDeletePasscodeScreen},  //MENU_DELETEPASSCODE
+  {LABELBACKLIGHT, CURSOR_VERTICAL, 2, nullptr, &StateMachine::inputBacklightMode, &Display::displayChangeBacklightModeScreen},  //MENU_BACKLIGHT
+  {LABELFACTORYRESET, CURSOR_HORIZONTAL, 1, nullptr, &StateMachine::inputFactoryReset, &Display::displayFactoryResetScreen}  //MENU_FACTORYRESET
+};
+
+
+
+//Copies the entry of the given menu from flash
+void Menu::get(uint8_t state, MenuEntry& entry)
+{
+  if (state >= NUMMENUS) state = MENU_MAIN;
+  memcpy_P(&entry, &ENTRIES[state], sizeof(entry));
+}
+
+
+
+//Returns the label of the given menu in the Root Menu (a string in flash, to be used with print())
+const __FlashStringHelper* Menu::getLabel(uint8_t state)
+{
+  MenuEntry entry;
+  get(state, entry);
+  return((const __FlashStringHelper*)entry.label);
+}
@@ -0,0 +1,89 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This library has been made for the final project of my career, an Arduino Smart Alarm. You may reuse all or part
+  of the included code freely for non-commercial purposes.
+
+  Table of the menus of the Central Node. Each menu (a state of the FSM in StateMachine.h) is declared once, in
+  Menu.cpp, with everything both the StateMachine and the Display need to know about it:
+   - Its label in the Root Menu. Every menu after MENU_ROOT is listed there, in the order of MenuState.
+   - Which arrows move its cursor (Up/Down or Left/Right) and how far. In menus that are vertical lists, Left goes
+     back to the Main Screen.
+   - The StateMachine methods that prepare it when it is entered and handle the keys the cursor doesn't use.
+   - The Display method that draws it.
+  The table is kept in flash (PROGMEM), and both classes look up the current menu by its number instead of
+  having a switch each. To add a menu, add its state to MenuState and its entry to Menu::ENTRIES.
+*/
+
+#ifndef Menu_h
+#define Menu_h
+
+#include "Arduino.h"
+#include "ClockService.h"
+
+
+class StateMachine;
+class Display;
+class AnalogKeyboard;
+
+
+////States of the FSM, one per menu
+enum MenuState : uint8_t
+{
+  MENU_MAIN,  //Main Screen (clock, date, alarm state)
+  MENU_ROOT,  //List of the menus below
+  MENU_TIME,
+  MENU_DATE,
+  MENU_ADDPASSCODE,
+  MENU_DELETEPASSCODE,
+  MENU_BACKLIGHT,
+  MENU_FACTORYRESET,
+  NUMMENUS
+};
+
+const uint8_t MENU_FIRSTLISTED = MENU_TIME;  //First menu listed in the Root Menu
+const uint8_t NUMLISTEDMENUS = NUMMENUS - MENU_FIRSTLISTED;
+
+
+////Keys that move the cursor of a menu
+enum MenuCursor : uint8_t
+{
+  CURSOR_NONE,
+  CURSOR_VERTICAL,  //Up and Down. Left goes back to the Main Screen
+  CURSOR_HORIZONTAL  //Left and Right
+};
+
+const uint8_t CURSOR_PASSCODES = 0xFF;  //Last cursor position of a list of the stored passcodes (it depends on their number)
+
+
+typedef void (StateMachine::*MenuEnter)(ClockService& clock);
+typedef void (StateMachine::*MenuInput)(const AnalogKeyboard& analogKeyboard, ClockService& clock);
+typedef void (Display::*MenuRender)(const StateMachine& stateMachine, ClockService& clock);
+
+
+struct MenuEntry
+{
+  const char* label;  //Name in the Root Menu (in flash), or NULL
+  MenuCursor cursor;
+  uint8_t lastCursor;  //Highest cursor position, or CURSOR_PASSCODES
+  MenuEnter enter;  //Prepares the menu when it is entered (may be NULL)
+  MenuInput input;  //Handles the keys that don't move the cursor
+  MenuRender render;
+};
+
+
+
+class Menu
+{
+  public:
+
+    static void get(uint8_t state, MenuEntry& entry);
+    static const __FlashStringHelper* getLabel(uint8_t state);
+
+
+  private:
+
+    static const MenuEntry ENTRIES[NUMMENUS];
+};
+
+
+#endif
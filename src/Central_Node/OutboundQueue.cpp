@@ -0,0 +1,135 @@
+#include "OutboundQueue.h"
+
+
+
+//Constructor. The queue sends its messages through the given network
+OutboundQueue::OutboundQueue(RF24Network& network) : network(network)
+{
+  for (int i=0; i<OUTBOUNDSLOTS; i++) messages[i].state = DELIVERY_FREE;
+  nextSlot = 0;
+}
+
+
+
+/*
+Queues a message for the node toNode. It will be sent by update(). Returns the id of the message, or -1 if the 
+queue is full or the payload too long. The callback (if any) will be called with the id, whether the message 
+was delivered and the given context.
+*/
+int OutboundQueue::send(uint16_t toNode, unsigned char type, const void* payload, uint8_t size, DeliveryCallback callback, void* context)
+{
+  if (size > MAXOUTBOUNDPAYLOAD) return(-1);
+  
+  int id = findFreeSlot();
+  if (id < 0) return(-1);
+  
+  OutboundMessage& message = messages[id];
+  message.toNode = toNode;
+  message.type = type;
+  message.size = size;
+  if (size) memcpy(message.payload, payload, size);
+  message.attempts = 0;
+  message.state = DELIVERY_PENDING;
+  message.nextAttempt = millis();
+  message.callback = callback;
+  message.context = context;
+  return(id);
+}
+
+
+
+//Must be called regularly. Sends all new messages, and retries at most one message whose waiting time is over
+void OutboundQueue::update()
+{
+  for (int id=0; id<OUTBOUNDSLOTS; id++){
+    if ((messages[id].state == DELIVERY_PENDING) && (messages[id].attempts == 0)) attempt(id);
+  }
+  
+  unsigned long now = millis();
+  for (int i=0; i<OUTBOUNDSLOTS; i++){
+    uint8_t id = (nextSlot + i) % OUTBOUNDSLOTS;
+    if ((messages[id].state == DELIVERY_PENDING) && (messages[id].attempts > 0) && ((long)(now - messages[id].nextAttempt) >= 0)){
+      nextSlot = (id + 1) % OUTBOUNDSLOTS;
+      attempt(id);
+      return;
+    }
+  }
+}
+
+
+
+//Returns the state of the message with the given id. Finished messages keep their state until the slot is reused
+DeliveryState OutboundQueue::getState(uint8_t id)
+{
+  if (id >= OUTBOUNDSLOTS) return(DELIVERY_FREE);
+  return(messages[id].state);
+}
+
+
+
+//Checks if a message of the given type is still waiting to be sent to the given node
+bool OutboundQueue::isPending(uint16_t toNode, unsigned char type)
+{
+  for (int i=0; i<OUTBOUNDSLOTS; i++){
+    if ((messages[i].state == DELIVERY_PENDING) && (messages[i].toNode == toNode) && (messages[i].type == type)) return(true);
+  }
+  return(false);
+}
+
+
+
+//Returns how many messages are waiting to be sent
+uint8_t OutboundQueue::pending()
+{
+  uint8_t count = 0;
+  for (int i=0; i<OUTBOUNDSLOTS; i++){
+    if (messages[i].state == DELIVERY_PENDING) count++;
+  }
+  return(count);
+}
+
+
+
+//Returns a slot that is not waiting to be sent, preferably one never used (so finished states last longer), or -1
+int OutboundQueue::findFreeSlot()
+{
+  int finished = -1;
+  for (int i=0; i<OUTBOUNDSLOTS; i++){
+    if (messages[i].state == DELIVERY_FREE) return(i);
+    if ((messages[i].state != DELIVERY_PENDING) && (finished < 0)) finished = i;
+  }
+  return(finished);
+}
+
+
+
+//Tries to send a message once. If it fails, schedules the next attempt or gives the message up
+void OutboundQueue::attempt(uint8_t id)
+{
+  OutboundMessage& message = messages[id];
+  RF24NetworkHeader header(message.toNode, message.type);
+  message.attempts++;
+  
+  if (network.write(header, message.payload, message.size)){
+    finish(id, DELIVERY_SENT);
+    return;
+  }
+  
+  if (message.attempts >= MAXSENDATTEMPTS){
+    finish(id, DELIVERY_FAILED);
+    return;
+  }
+  
+  unsigned long wait = FIRSTRETRYDELAY << (message.attempts - 1);
+  if (wait > MAXRETRYDELAY) wait = MAXRETRYDELAY;
+  message.nextAttempt = millis() + wait;
+}
+
+
+
+//Sets the final state of a message and lets its sender know
+void OutboundQueue::finish(uint8_t id, DeliveryState state)
+{
+  messages[id].state = state;
+  if (messages[id].callback) messages[id].callback(id, state == DELIVERY_SENT, messages[id].context);
+}
@@ -0,0 +1,75 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This library has been made for the final project of my career, an Arduino Smart Alarm. You may reuse all or part 
+  of the included code freely for non-commercial purposes.
+  
+  Queue of messages waiting to be sent to other nodes. Sending a message to a node that is powered off or out of 
+  range fails, and retrying right away in a loop would freeze the Central Node while the node stays unreachable. 
+  Instead, messages are stored here and update() (called on every pass of the loop) tries to send them:
+   - New messages are all sent in the same call, one right after the other, so that messages queued together 
+     (like an alert for several sirens) go out together. Retries are limited to one per call, so that unreachable 
+     nodes never make the loop wait for more than one radio write.
+   - A failed message is retried later, doubling the waiting time after each failure (exponential backoff), 
+     up to MAXSENDATTEMPTS attempts. After that it is given up as failed.
+   - send() returns an id with which the state of the message can be checked (getState()). Optionally, a callback 
+     is called once the message has been delivered or given up.
+  The payload is copied into the queue, so the caller doesn't need to keep it.
+*/
+
+#ifndef OutboundQueue_h
+#define OutboundQueue_h
+
+
+#include "Arduino.h"
+#include <RF24Network.h>
+
+
+const int OUTBOUNDSLOTS = 8;  //Messages that can be waiting at the same time
+const int MAXOUTBOUNDPAYLOAD = 8;  //Bytes
+const uint8_t MAXSENDATTEMPTS = 10;
+const unsigned long FIRSTRETRYDELAY = 10;  //Milliseconds to wait after the first failure. Doubles after each failure
+const unsigned long MAXRETRYDELAY = 2000;  //Milliseconds
+
+
+enum DeliveryState {DELIVERY_FREE, DELIVERY_PENDING, DELIVERY_SENT, DELIVERY_FAILED};
+
+typedef void (*DeliveryCallback)(uint8_t id, bool delivered, void* context);
+
+
+
+class OutboundQueue
+{
+  public:
+    OutboundQueue(RF24Network& network);
+    int send(uint16_t toNode, unsigned char type, const void* payload, uint8_t size, DeliveryCallback callback = NULL, void* context = NULL);
+    void update();
+    DeliveryState getState(uint8_t id);
+    bool isPending(uint16_t toNode, unsigned char type);
+    uint8_t pending();
+    
+    
+  private:
+    struct OutboundMessage
+    {
+      uint16_t toNode;
+      unsigned char type;
+      uint8_t size;
+      byte payload[MAXOUTBOUNDPAYLOAD];
+      uint8_t attempts;
+      DeliveryState state;
+      unsigned long nextAttempt;  //millis() at which it can be sent again
+      DeliveryCallback callback;
+      void* context;
+    };
+    
+    RF24Network& network;
+    OutboundMessage messages[OUTBOUNDSLOTS];
+    uint8_t nextSlot;  //Where update() starts looking, so that all messages get their turn
+    
+    int findFreeSlot();
+    void attempt(uint8_t id);
+    void finish(uint8_t id, DeliveryState state);
+};
+
+
+#endif
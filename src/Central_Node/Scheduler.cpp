@@ -0,0 +1,98 @@
+#include "Scheduler.h"
+
+
+//Constructor. Starts with no tasks
+Scheduler::Scheduler()
+{
+  taskCount = 0;
+}
+
+
+
+/*
+Registers a new task. Times are in microseconds. Returns the task's index (needed for the statistics methods), 
+or -1 if there is no room for more tasks.
+*/
+int Scheduler::addTask(TaskFunction function, unsigned long period, uint8_t priority, unsigned long deadline)
+{
+  if (taskCount >= MAXTASKS) return(-1);
+  
+  Task& task = tasks[taskCount];
+  task.function = function;
+  task.period = period;
+  task.deadline = deadline;
+  task.lastRelease = micros();
+  task.priority = priority;
+  task.deadlineMisses = 0;
+  task.maxLateness = 0;
+  
+  return(taskCount++);
+}
+
+
+
+/*
+Must be called in every pass of loop(). Runs every task with period 0 and, at most, one periodic task: the 
+due one with the highest priority. Between two due tasks with the same priority, the one closest to missing 
+its deadline goes first.
+*/
+void Scheduler::run()
+{
+  int chosen = -1;
+  long chosenSlack = 0;
+  unsigned long now = micros();
+  
+  for (uint8_t i = 0; i < taskCount; i++){
+    Task& task = tasks[i];
+    
+    if (task.period == 0){
+      task.function();
+      continue;
+    }
+    
+    unsigned long elapsed = now - task.lastRelease;
+    if (elapsed < task.period) continue;  //Not due yet
+    
+    long slack = (long)task.deadline - (long)(elapsed - task.period);
+    if ((chosen < 0) || (task.priority > tasks[chosen].priority) || 
+        ((task.priority == tasks[chosen].priority) && (slack < chosenSlack))){
+      chosen = i;
+      chosenSlack = slack;
+    }
+  }
+  
+  if (chosen < 0) return;
+  Task& task = tasks[chosen];
+  
+  //Keep track of how late the task is starting
+  now = micros();
+  unsigned long lateness = now - task.lastRelease - task.period;
+  if (lateness > task.maxLateness) task.maxLateness = lateness;
+  if (lateness > task.deadline) task.deadlineMisses++;
+  
+  //Schedule the next run one period after this one was due. If we have fallen more than a whole period 
+  //behind, skip the lost runs instead of running the task several times in a row to catch up
+  if (lateness < task.period) task.lastRelease += task.period;
+  else task.lastRelease = now;
+  
+  task.function();
+}
+
+
+
+//Returns how many times the given task started later than its deadline
+unsigned int Scheduler::getDeadlineMisses(int task)
+{
+  if ((task < 0) || (task >= taskCount)) return(0);
+  return(tasks[task].deadlineMisses);
+}
+
+
+
+//Returns the longest time, in microseconds, that the given task has waited after becoming due
+unsigned long Scheduler::getMaxLateness(int task)
+{
+  if ((task < 0) || (task >= taskCount)) return(0);
+  return(tasks[task].maxLateness);
+}
+
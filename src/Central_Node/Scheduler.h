@@ -0,0 +1,60 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This library has been made for the final project of my career, an Arduino Smart Alarm. You may reuse all or part 
+  of the included code freely for non-commercial purposes.
+  
+  Small cooperative scheduler for the Central Node's main loop. Each subsystem is registered as a task with its own 
+  period, priority and deadline, and run() is called from loop() as often as possible:
+   - Tasks with period 0 run on every pass, in the order they were added (used for the radio, which is the 
+     latency critical path).
+   - Of the periodic tasks that are due, only the one with the highest priority runs in each pass. This way slow 
+     tasks (like refreshing the LCD) never run back to back and the radio gets polled between them.
+  Tasks are never interrupted, so each one should return quickly. A task that starts later than its deadline 
+  (measured from the moment it became due) is counted as a deadline miss.
+*/
+
+#ifndef Sched_h
+#define Sched_h
+
+
+#include "Arduino.h"
+
+
+const int MAXTASKS = 12;
+
+typedef void (*TaskFunction)();
+
+
+class Scheduler
+{
+  public:
+  
+    Scheduler();
+    
+    int addTask(TaskFunction function, unsigned long period, uint8_t priority, unsigned long deadline);
+    void run();
+    
+    unsigned int getDeadlineMisses(int task);
+    unsigned long getMaxLateness(int task);
+    
+    
+  private:
+  
+    struct Task
+    {
+      TaskFunction function;
+      unsigned long period;    //Microseconds between runs. 0 means every pass
+      unsigned long deadline;  //Microseconds the task may wait after becoming due
+      unsigned long lastRelease;  //micros() at the moment the task last became due
+      uint8_t priority;  //Higher runs first
+      
+      unsigned int deadlineMisses;
+      unsigned long maxLateness;
+    };
+    
+    Task tasks[MAXTASKS];
+    uint8_t taskCount;
+};
+
+
+#endif
@@ -0,0 +1,267 @@
+#include "SensorRegistry.h"
+#include "EventLog.h"
+#include "Log.h"
+
+
+//Location of the registry in the EEPROM. 4 bytes per sensor (address, type and zone), from 1720 to 1847
+const int REGISTRYADDRESS = 1720;
+const int SENSORRECORDSIZE = 4;
+
+SensorRegistry::Sensor SensorRegistry::sensors[MAXSENSORS];
+uint8_t SensorRegistry::count;
+uint8_t SensorRegistry::hashTable[HASHSLOTS];
+uint8_t SensorRegistry::oldest = NONE;
+uint8_t SensorRegistry::newest = NONE;
+uint8_t SensorRegistry::lostCount;
+
+const unsigned long LOSTTIMEOUT = MISSEDHEARTBEATS*HEARTBEATINTERVAL + HEARTBEATINTERVAL/2;  //Some margin for late heartbeats
+
+
+
+//Loads the registered sensors from the EEPROM. Must be called once at startup
+void SensorRegistry::begin()
+{
+  count = 0;
+  memset(hashTable, EMPTYSLOT, sizeof(hashTable));
+  oldest = newest = NONE;
+  lostCount = 0;
+  
+  for (int i=0; i<MAXSENSORS; i++){
+    int address = REGISTRYADDRESS + i*SENSORRECORDSIZE;
+    unsigned char type = EEPROMQueue::read(address+2);
+    if ((type < 'A') || (type > 'Z')) break;  //End of the list (an erased EEPROM reads 0xFF)
+    
+    sensors[count].address = word(EEPROMQueue::read(address+1), EEPROMQueue::read(address));
+    sensors[count].type = type;
+    sensors[count].zone = EEPROMQueue::read(address+3);
+    sensors[count].lastSeen = 0;
+    sensors[count].supervised = false;
+    sensors[count].lost = false;
+    insert(count);
+    count++;
+  }
+  
+  //Mark the end of the list, in case the EEPROM held something else after it
+  if (count < MAXSENSORS) EEPROMQueue::write(REGISTRYADDRESS + count*SENSORRECORDSIZE + 2, 0xFF);
+}
+
+
+
+//Returns true for the types of node the registry accepts: Movement Detector (E), Window (G), siren (S) and Key Tray (K)
+bool SensorRegistry::isValidType(unsigned char type)
+{
+  switch(type){
+    case 'E': case 'G': case 'S': case 'K': return(true);
+    default: return(false);
+  }
+}
+
+
+
+/*
+Adds a sensor to the registry, or updates its type and zone if it was already in it. Returns the number of the 
+sensor, or -1 if the registry is full. The EEPROM is only written if something has changed.
+*/
+int SensorRegistry::registerSensor(uint16_t address, unsigned char type, uint8_t zone)
+{
+  int sensor = find(address);
+  
+  if (sensor < 0){
+    if (count >= MAXSENSORS) return(-1);
+    sensor = count++;
+    sensors[sensor].address = address;
+    sensors[sensor].lastSeen = 0;
+    sensors[sensor].supervised = false;
+    sensors[sensor].lost = false;
+    insert(sensor);
+  }
+  else if ((sensors[sensor].type == type) && (sensors[sensor].zone == zone)) return(sensor);
+  
+  sensors[sensor].type = type;
+  sensors[sensor].zone = zone;
+  save(sensor);
+  return(sensor);
+}
+
+
+
+//Returns the number of the sensor with the given address, or -1 if it isn't registered
+int SensorRegistry::find(uint16_t address)
+{
+  for (uint8_t slot = hash(address); hashTable[slot] != EMPTYSLOT; slot = (slot + 1) % HASHSLOTS){
+    if (sensors[hashTable[slot]].address == address) return(hashTable[slot]);
+  }
+  return(-1);
+}
+
+
+
+//Records that a message has just been received from the given sensor. If it was lost, it is not anymore
+void SensorRegistry::seen(int sensor)
+{
+  sensors[sensor].lastSeen = millis();
+  if (!sensors[sensor].supervised) return;
+  
+  if (sensors[sensor].lost){
+    sensors[sensor].lost = false;
+    lostCount--;
+    LOG_WARNING("Node %o is back\n",sensors[sensor].address);
+    EventLog::add(EVENT_NODEBACK, sensors[sensor].address);
+  }
+  else unlink(sensor);
+  append(sensor);  //Now it is the newest
+}
+
+
+
+//Starts checking that the given sensor keeps sending heartbeats. Called when its first heartbeat arrives
+void SensorRegistry::supervise(int sensor)
+{
+  if (sensors[sensor].supervised) return;
+  sensors[sensor].supervised = true;
+  sensors[sensor].lost = false;
+  append(sensor);
+}
+
+
+
+/*
+Marks as lost the supervised nodes that haven't been heard from for MISSEDHEARTBEATS heartbeat intervals. 
+Must be called regularly (once per second is enough). Only the oldest nodes of the list are looked at.
+*/
+void SensorRegistry::checkLiveness()
+{
+  unsigned long now = millis();
+  
+  while ((oldest != NONE) && (now - sensors[oldest].lastSeen > LOSTTIMEOUT)){
+    uint8_t sensor = oldest;
+    unlink(sensor);
+    sensors[sensor].lost = true;
+    lostCount++;
+    LOG_ERROR("Node %o lost: no heartbeat for %lu s\n",sensors[sensor].address,(now - sensors[sensor].lastSeen)/1000);
+    EventLog::add(EVENT_NODELOST, sensors[sensor].address);
+  }
+}
+
+
+
+//Returns how many sensors are registered. They are numbered from 0 to getCount()-1
+int SensorRegistry::getCount()
+{
+  return(count);
+}
+
+
+
+uint16_t SensorRegistry::getAddress(int sensor)
+{
+  return(sensors[sensor].address);
+}
+
+
+
+unsigned char SensorRegistry::getType(int sensor)
+{
+  return(sensors[sensor].type);
+}
+
+
+
+uint8_t SensorRegistry::getZone(int sensor)
+{
+  return(sensors[sensor].zone);
+}
+
+
+
+unsigned long SensorRegistry::getLastSeen(int sensor)
+{
+  return(sensors[sensor].lastSeen);
+}
+
+
+
+//Returns true if the given sensor has stopped sending heartbeats
+bool SensorRegistry::isLost(int sensor)
+{
+  return(sensors[sensor].lost);
+}
+
+
+
+//Returns how many nodes are lost
+int SensorRegistry::getLostCount()
+{
+  return(lostCount);
+}
+
+
+
+//Prints the list of registered sensors in Serial console
+void SensorRegistry::print()
+{
+  printf_P(PSTR("\nAddress  Type  Zone  Last seen [s]\n"));
+  for (int i=0; i<count; i++){
+    printf_P(PSTR("  %-6o  %c     %-4u  "),sensors[i].address,sensors[i].type,sensors[i].zone);
+    if (sensors[i].lastSeen) printf_P(PSTR("%lu"),sensors[i].lastSeen/1000);
+    else printf_P(PSTR("never"));
+    if (sensors[i].lost) printf_P(PSTR("  LOST"));
+    printf_P(PSTR("\n"));
+  }
+  printf_P(PSTR("%u of %u sensors registered, %u lost\n"),count,MAXSENSORS,lostCount);
+}
+
+
+
+//Multiplicative hash of an address. Uses the high bits of the product, which depend on all the bits of the address
+uint8_t SensorRegistry::hash(uint16_t address)
+{
+  return(((uint16_t)(address * 40503u) >> 8) % HASHSLOTS);
+}
+
+
+
+//Adds a sensor to the hash table, in the first empty slot from the one given by its address
+void SensorRegistry::insert(uint8_t sensor)
+{
+  uint8_t slot = hash(sensors[sensor].address);
+  while (hashTable[slot] != EMPTYSLOT) slot = (slot + 1) % HASHSLOTS;
+  hashTable[slot] = sensor;
+}
+
+
+
+//Writes a sensor to the EEPROM. The last sensor of the list is followed by the end of list mark, if there is room for it
+void SensorRegistry::save(uint8_t sensor)
+{
+  int address = REGISTRYADDRESS + sensor*SENSORRECORDSIZE;
+  EEPROMQueue::write(address, lowByte(sensors[sensor].address));
+  EEPROMQueue::write(address+1, highByte(sensors[sensor].address));
+  EEPROMQueue::write(address+2, sensors[sensor].type);
+  EEPROMQueue::write(address+3, sensors[sensor].zone);
+  if ((sensor == count-1) && (sensor+1 < MAXSENSORS)) EEPROMQueue::write(address + SENSORRECORDSIZE + 2, 0xFF);
+}
+
+
+
+//Takes a sensor out of the list of supervised nodes
+void SensorRegistry::unlink(uint8_t sensor)
+{
+  Sensor& entry = sensors[sensor];
+  if (entry.older != NONE) sensors[entry.older].newer = entry.newer;
+  else oldest = entry.newer;
+  if (entry.newer != NONE) sensors[entry.newer].older = entry.older;
+  else newest = entry.older;
+}
+
+
+
+//Adds a sensor at the end of the list of supervised nodes (the end of the most recently heard from)
+void SensorRegistry::append(uint8_t sensor)
+{
+  sensors[sensor].older = newest;
+  sensors[sensor].newer = NONE;
+  if (newest != NONE) sensors[newest].newer = sensor;
+  else oldest = sensor;
+  newest = sensor;
+}
@@ -0,0 +1,101 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This library has been made for the final project of my career, an Arduino Smart Alarm. You may reuse all or part 
+  of the included code freely for non-commercial purposes.
+  
+  Registry of the sensor nodes known by the Central Node. Each sensor has its own address in the network, and 
+  announces itself with a registration message (type R) when it is powered on, telling its type (the type of the 
+  alerts it sends: E for Movement Detector Nodes, G for Window Nodes) and the zone of the building it guards. 
+  For every sensor the registry keeps:
+   - Address, type and zone. These are also stored in the EEPROM, so they survive a reset of the Central Node 
+     (sensors only register once, when they are powered on).
+   - The last time a message was received from it (in RAM only).
+  Alerts from sensors that never registered (for example, those with older firmware) add them with zone 0.
+  Only the types in isValidType() are accepted: any other byte stored as a type would be taken as the end of the 
+  list at the next startup, and every node after it would be forgotten.
+  Sensors are looked up by address through a hash table, so finding the zone of an alert takes the same time 
+  no matter how many sensors there are.
+  
+  The registry also supervises that nodes are alive. Nodes send a heartbeat message (type H) every 
+  HEARTBEATINTERVAL, and the first one puts them under supervision. A supervised node from which nothing has been 
+  heard for MISSEDHEARTBEATS intervals is marked as lost, until it is heard from again. The other nodes (siren S, 
+  Key Tray K) are registered by their heartbeats too, with their own types. They are stored in the EEPROM like the 
+  sensors on purpose: after a reset of the Central Node, the list printed over Serial still shows every node of 
+  the system, and one that never comes back shows up as never seen instead of missing. Each takes one of the 
+  MAXSENSORS places. To avoid going through every node each time, supervised nodes are kept in a list ordered by 
+  the time they were last heard from: a node that sends something is moved to the end of the list, and 
+  checkLiveness() only has to look at the beginning of it.
+  Like Settings, it uses static methods, so it is not necessary to create an instance.
+*/
+
+#ifndef SensorReg_h
+#define SensorReg_h
+
+
+#include "Arduino.h"
+#include "EEPROMQueue.h"
+
+
+const int MAXSENSORS = 32;
+const uint8_t NOZONE = 0;  //Zone of the sensors that didn't say theirs
+const unsigned long HEARTBEATINTERVAL = 60000;  //Milliseconds between heartbeats of each node
+const int MISSEDHEARTBEATS = 3;  //Heartbeats missed before a node is considered lost
+
+
+class SensorRegistry
+{
+  public:
+    
+    static void begin();
+    static bool isValidType(unsigned char type);
+    static int registerSensor(uint16_t address, unsigned char type, uint8_t zone);
+    static int find(uint16_t address);
+    static void seen(int sensor);
+    static void supervise(int sensor);
+    static void checkLiveness();
+    
+    static int getCount();
+    static uint16_t getAddress(int sensor);
+    static unsigned char getType(int sensor);
+    static uint8_t getZone(int sensor);
+    static unsigned long getLastSeen(int sensor);
+    static bool isLost(int sensor);
+    static int getLostCount();
+    
+    static void print();
+    
+    
+  private:
+  
+    struct Sensor
+    {
+      uint16_t address;
+      unsigned char type;
+      uint8_t zone;
+      unsigned long lastSeen;  //millis() of the last message received from it
+      bool supervised;  //It sends heartbeats
+      bool lost;
+      uint8_t older;  //Neighbours in the list of supervised nodes, ordered by lastSeen. NONE at the ends
+      uint8_t newer;
+    };
+    
+    static const int HASHSLOTS = 2*MAXSENSORS;  //Kept half empty at most, so that probe sequences stay short
+    static const uint8_t EMPTYSLOT = 0xFF;
+    static const uint8_t NONE = 0xFF;
+    
+    static Sensor sensors[MAXSENSORS];
+    static uint8_t count;
+    static uint8_t hashTable[HASHSLOTS];  //Number of the sensor with each address, found by hashing it
+    static uint8_t oldest;  //Ends of the list of supervised nodes that are not lost
+    static uint8_t newest;
+    static uint8_t lostCount;
+    
+    static uint8_t hash(uint16_t address);
+    static void insert(uint8_t sensor);
+    static void save(uint8_t sensor);
+    static void unlink(uint8_t sensor);
+    static void append(uint8_t sensor);
+};
+
+
+#endif
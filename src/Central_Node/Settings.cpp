@@ -1,6 +1,30 @@
 #include "Settings.h"
 
 
+//EEPROM addresses of each setting. The alarm state and backlight mode are now kept in the SettingsLog. 
+//Their old addresses are only read once, to carry the values over from older firmware
+const int ALARMSTATEADDRESS = 0;
+const int BACKLIGHTMODEADDRESS = 1;
+const int SIRENNODESADDRESS = 2;  //Number of sirens, then their addresses (2 bytes each, low byte first)
+const int PASSCODESADDRESS = 100;  //Only if the passcodes are in the internal EEPROM (the default)
+static_assert(SIRENNODESADDRESS + 1 + MAXSIRENNODES*2 <= PASSCODESADDRESS, "The list of sirens overlaps the passcodes");
+
+EEPROMStorage internalEEPROM;
+StorageBackend* Settings::passcodeStorage = &internalEEPROM;
+unsigned long Settings::passcodesAddress = PASSCODESADDRESS;
+
+bool Settings::alarmActivated;
+byte Settings::backlightMode;
+byte Settings::passcodes[MAXSTOREDPASSCODES][PASSCODELENGTH];
+uint16_t Settings::sirenNodes[MAXSIRENNODES];
+uint8_t Settings::sirenCount;
+
+uint8_t Settings::sortedSlots[MAXSTOREDPASSCODES];
+int Settings::storedCount;
+byte Settings::usedSlots[(MAXSTOREDPASSCODES+7)/8];
+
+
+
 //Constructor. Not needed, since all methods are static methods
 Settings::Settings()
 {  
@@ -9,13 +33,65 @@ Settings::Settings()
 
 
 
+/*
+Moves the passcode database to another storage (for example an external FRAM chip), starting at the given address. 
+It must be called before begin(). The passcodes already stored in the previous storage are not copied.
+*/
+void Settings::setPasscodeStorage(StorageBackend& storage, unsigned long address)
+{
+  passcodeStorage = &storage;
+  passcodesAddress = address;
+}
+
+
+
+//Loads all settings from the EEPROM into RAM. Must be called once at startup, before any other method
+void Settings::begin()
+{
+  flush();  //Make sure we read what has been written so far
+  SettingsLog::begin();
+  
+  byte value;
+  if (SettingsLog::read(LOGKEY_ALARMSTATE, value)) alarmActivated = value;
+  else alarmActivated = EEPROM.read(ALARMSTATEADDRESS);
+  
+  if (SettingsLog::read(LOGKEY_BACKLIGHTMODE, value)) backlightMode = value;
+  else backlightMode = EEPROM.read(BACKLIGHTMODEADDRESS);
+  
+  loadSirenNodes();
+  
+  passcodeStorage->readBlock(passcodesAddress, &passcodes[0][0], sizeof(passcodes));
+  buildIndex();
+}
+
+
+
 /*
 Sets alarm activated or deactivated. 
 If activated is true, activates the alarm. If false, deactivates the alarm.
 */
 void Settings::setAlarmState(bool activated)
 {
-  EEPROM.write(0, activated);
+  alarmActivated = activated;
+  SettingsLog::write(LOGKEY_ALARMSTATE, activated);
+}
+
+
+
+//Must be called regularly. Lets the storage write pending changes in the background
+void Settings::update()
+{
+  EEPROMQueue::update();
+  if (passcodeStorage != &internalEEPROM) passcodeStorage->update();
+}
+
+
+
+//Writes all pending changes to permanent storage, waiting for them to finish. Use it before powering down
+void Settings::flush()
+{
+  EEPROMQueue::flush();
+  passcodeStorage->flush();
 }
 
 
@@ -23,123 +99,211 @@ void Settings::setAlarmState(bool activated)
 //Returns true if alarm is activated
 bool Settings::isAlarmActivated()
 {
-  return(EEPROM.read(0));
+  return(alarmActivated);
 }
 
 
 
-//Compares a given passcode with all stored passcodes in database. If a coincidence is found, returns true
-bool Settings::isPasscodeInDatabase(byte passcode[PASSCODELENGTH])
+/*
+Looks for a passcode in the sorted index with a binary search. Returns its position in the index if found, or 
+otherwise the position where it would have to be inserted to keep the index sorted.
+*/
+int Settings::findPasscode(byte passcode[PASSCODELENGTH], bool& found)
 {
-  bool found = false;
-  int i=0;
-  while((i<MAXSTOREDPASSCODES) && (!found)){
-    found = comparePasscodes(passcode,getStoredPasscode(i));
-    i++;
+  int low = 0;
+  int high = storedCount;
+  
+  while (low < high){
+    int middle = (low + high) / 2;
+    int order = memcmp(passcodes[sortedSlots[middle]], passcode, PASSCODELENGTH);
+    
+    if (order == 0){
+      found = true;
+      return(middle);
+    }
+    if (order < 0) low = middle + 1;
+    else high = middle;
   }
+  
+  found = false;
+  return(low);
+}
+
+
+
+//Returns true if the given passcode is stored in the database
+bool Settings::isPasscodeInDatabase(byte passcode[PASSCODELENGTH])
+{
+  bool found;
+  findPasscode(passcode, found);
   return(found);
 }
 
 
 
-//Checks if the given passcode is the same as the one stored in given index inside the database
+//Checks if two passcodes are the same
 bool Settings::comparePasscodes(byte passcode1[PASSCODELENGTH], byte passcode2[PASSCODELENGTH])
 {    
-  bool foundDifference = false;
-  int i = 0;
-  while((i < PASSCODELENGTH) && (!foundDifference)){
-    foundDifference = (passcode1[i] != passcode2[i]);
-    i++;
-  }
-  return (!foundDifference);  
+  return(memcmp(passcode1, passcode2, PASSCODELENGTH) == 0);  
 }
 
 
 
-//Returns the passcode stored in database position 'index'
+//Returns the stored passcode at position 'index' of the database, in ascending order (0 to getStoredPasscodeCount()-1)
 byte* Settings::getStoredPasscode(int index)
 {  
-  static byte storedPasscode[PASSCODELENGTH];
-  int address = 100 + (index*PASSCODELENGTH);
-  EEPROM.get(address,storedPasscode);
-  return(storedPasscode);
+  return(passcodes[sortedSlots[index]]);
+}
+
+
+
+//Returns how many passcodes are stored in the database
+int Settings::getStoredPasscodeCount()
+{
+  return(storedCount);
 }
 
 
-//Attempts adding the given passcode to the database inside the EEPROM
+
+//Attempts adding the given passcode to the database
 void Settings::addNewPasscode(byte newPasscode[PASSCODELENGTH])
 {  
-  if(comparePasscodes(newPasscode,emptyPasscode())){  //Do not add empty passcodes
-    printf("\nInvalid passcode. It cannot be full of 0s.\n");
+  if(isEmptyPasscode(newPasscode)){  //Do not add empty passcodes
+    LOG_WARNING("Invalid passcode. It cannot be full of 0s.\n");
     return;
   } 
-  if(isPasscodeInDatabase(newPasscode)){  //Do not add repeated passcodes
-    printf("\nInvalid passcode. Already in database.\n");
+  
+  bool found;
+  int position = findPasscode(newPasscode, found);
+  if(found){  //Do not add repeated passcodes
+    LOG_WARNING("Invalid passcode. Already in database.\n");
     return;
   }
   
-  bool added = false;  
-  
-  int index = 0;
-  while((index < MAXSTOREDPASSCODES) && (!added)){
-    if (isPositionEmpty(index)){
-      int EEaddress = 100 + index*PASSCODELENGTH;
-      for(int i=0; i<PASSCODELENGTH; i++) EEPROM.write(EEaddress+i,newPasscode[i]);
-      added = true;
-    }
-    index++;
+  int slot = findFreeSlot();
+  if(slot < 0){
+    LOG_ERROR("Database full. Could not add new passcode.\n");
+    return;
   }
-  if(added) printf("\nSuccessfully added to database in index %u.\n", index-1);
-  else printf("\nDatabase full. Could not add new passcode.\n");
   
-  printf("\nCurrent database :\n");
+  writeSlot(slot, newPasscode);
+  markSlot(slot, true);
+  
+  //Insert the slot in the index, keeping it sorted
+  memmove(&sortedSlots[position+1], &sortedSlots[position], storedCount - position);
+  sortedSlots[position] = slot;
+  storedCount++;
+  
+  LOG_INFO("Successfully added to database in index %u.\n", slot);
+  LOG_DEBUG("Current database :\n");
   printStoredPasscodes();
 }
 
 
 
+//Checks whether the slot with given index in the passcodes database is free
+bool Settings::isPositionEmpty(int slot)
+{   
+  return(!(usedSlots[slot/8] & (1 << (slot%8))));  
+}
+
+
+
 /*
-Checks whether the position with given index in the passcodes database is full or empty.
-Positions filled with 0s are considered empty.
+Checks whether a passcode read from a slot means the slot is empty. Slots filled with 0s are considered empty. 
+So are slots filled with 0xFF, which is how a brand new EEPROM (or a slot never used by older firmware) reads.
 */
-bool Settings::isPositionEmpty(int index)
-{   
-  bool isEmpty = comparePasscodes(emptyPasscode(), getStoredPasscode(index));
-  return(isEmpty);  
+bool Settings::isEmptyPasscode(byte passcode[PASSCODELENGTH])
+{
+  bool allZeros = true;
+  bool allOnes = true;
+  for (int i=0; i<PASSCODELENGTH; i++){
+    if (passcode[i] != 0x00) allZeros = false;
+    if (passcode[i] != 0xFF) allOnes = false;
+  }
+  return(allZeros || allOnes);
 }
 
 
 
-//Generates a passcode filled with 0s, which is considered empty
-byte* Settings::emptyPasscode()
+//Returns the first free slot, or -1 if the database is full. Whole bytes of the bitmap are skipped at once
+int Settings::findFreeSlot()
 {
-  static byte emptyPasscode[PASSCODELENGTH];
-  for (int i=0; i<PASSCODELENGTH; i++) emptyPasscode[i] = 0;
-  return(emptyPasscode); 
+  for (int i=0; i<(int)sizeof(usedSlots); i++){
+    if (usedSlots[i] == 0xFF) continue;
+    for (int bit=0; bit<8; bit++){
+      int slot = i*8 + bit;
+      if ((slot < MAXSTOREDPASSCODES) && isPositionEmpty(slot)) return(slot);
+    }
+  }
+  return(-1);
 }
 
 
 
-//Prints a list of stored passcodes in Serial console. Used mostly for debugging
+//Marks a slot as occupied or free in the bitmap
+void Settings::markSlot(int slot, bool used)
+{
+  if (used) usedSlots[slot/8] |= (1 << (slot%8));
+  else usedSlots[slot/8] &= ~(1 << (slot%8));
+}
+
+
+
+//Stores a passcode in the given slot, both in RAM and in permanent storage
+void Settings::writeSlot(int slot, byte passcode[PASSCODELENGTH])
+{
+  memcpy(passcodes[slot], passcode, PASSCODELENGTH);
+  passcodeStorage->writeBlock(passcodesAddress + slot*PASSCODELENGTH, passcode, PASSCODELENGTH);
+}
+
+
+
+//Rebuilds the bitmap of free slots and the sorted index from the passcodes in RAM. Used at startup
+void Settings::buildIndex()
+{
+  storedCount = 0;
+  memset(usedSlots, 0, sizeof(usedSlots));
+  
+  for (int slot=0; slot<MAXSTOREDPASSCODES; slot++){
+    if (isEmptyPasscode(passcodes[slot])) continue;
+    
+    bool found;
+    int position = findPasscode(passcodes[slot], found);
+    memmove(&sortedSlots[position+1], &sortedSlots[position], storedCount - position);
+    sortedSlots[position] = slot;
+    storedCount++;
+    markSlot(slot, true);
+  }
+}
+
+
+
+//Prints a list of stored passcodes in Serial console. Used only for debugging, so it is left out unless LOG_LEVEL is LOG_LEVEL_DEBUG
 void Settings::printStoredPasscodes()
 {  
-  printf_P(PSTR("Index    Passcode\n"));
+  LOG_DEBUG("Index    Passcode\n");
   for(int i=0; i<MAXSTOREDPASSCODES; i++){
-    printf_P(PSTR("  %u      "),i);
-    for(int j=0; j<PASSCODELENGTH; j++){
-      printf_P(PSTR("%u "),EEPROM.read(100 + i*PASSCODELENGTH + j));  
-    }
-    printf_P(PSTR("\n"));
+    if (isPositionEmpty(i)) continue;
+    LOG_DEBUG("  %-3u    %u %u %u %u %u %u\n",i,passcodes[i][0],passcodes[i][1],passcodes[i][2],passcodes[i][3],passcodes[i][4],passcodes[i][5]);
   }
+  LOG_DEBUG("%u of %u slots used\n",storedCount,MAXSTOREDPASSCODES);
 }
 
 
 
-//Deletes passcode with given index from database
+//Deletes the passcode at position 'index' of the database (see getStoredPasscode())
 void Settings::deletePasscode(int index)
 {  
-  int EEaddress = 100 + index*PASSCODELENGTH;
-  for(int i=0; i<PASSCODELENGTH; i++) EEPROM.write(EEaddress+i,0);
+  if ((index < 0) || (index >= storedCount)) return;
+  
+  int slot = sortedSlots[index];
+  byte empty[PASSCODELENGTH] = {0};
+  writeSlot(slot, empty);
+  markSlot(slot, false);
+  
+  memmove(&sortedSlots[index], &sortedSlots[index+1], storedCount - index - 1);
+  storedCount--;
 }
 
 
@@ -151,13 +315,97 @@ void Settings::deletePasscode(int index)
 //  - Mode 2: Always off
 void Settings::setBacklightMode(byte mode)
 {
-    EEPROM.write(1,mode);
+    backlightMode = mode;
+    SettingsLog::write(LOGKEY_BACKLIGHTMODE,mode);
 }
 
 //Returns backlight mode
 byte Settings::getBacklightMode()
 {
-  return(EEPROM.read(1)); 
+  return(backlightMode); 
+}
+
+
+
+
+//Returns how many siren nodes alerts are sent to
+int Settings::getSirenCount()
+{
+  return(sirenCount);
+}
+
+
+
+//Returns the address of the siren node at position 'index' of the list (0 to getSirenCount()-1)
+uint16_t Settings::getSirenNode(int index)
+{
+  return(sirenNodes[index]);
+}
+
+
+
+//Adds a node to the list of sirens. Returns false if the list is full or the node was already in it
+bool Settings::addSirenNode(uint16_t node)
+{
+  if (sirenCount >= MAXSIRENNODES) return(false);
+  for (int i=0; i<sirenCount; i++){
+    if (sirenNodes[i] == node) return(false);
+  }
+  
+  sirenNodes[sirenCount++] = node;
+  saveSirenNodes();
+  return(true);
+}
+
+
+
+//Removes a node from the list of sirens. The last siren can't be removed, or alerts wouldn't reach anyone
+bool Settings::removeSirenNode(uint16_t node)
+{
+  for (int i=0; i<sirenCount; i++){
+    if (sirenNodes[i] != node) continue;
+    if (sirenCount == 1) return(false);
+    
+    memmove(&sirenNodes[i], &sirenNodes[i+1], (sirenCount - i - 1) * sizeof(uint16_t));
+    sirenCount--;
+    saveSirenNodes();
+    return(true);
+  }
+  return(false);
+}
+
+
+
+/*
+Loads the list of sirens from the EEPROM. Older firmware didn't store it (the EEPROM holds 0s or 0xFFs there), 
+in which case the list only has the original Buzzer Node.
+*/
+void Settings::loadSirenNodes()
+{
+  sirenCount = EEPROMQueue::read(SIRENNODESADDRESS);
+  if ((sirenCount == 0) || (sirenCount > MAXSIRENNODES)){
+    sirenCount = 1;
+    sirenNodes[0] = DEFAULTSIRENNODE;
+    return;
+  }
+  
+  for (int i=0; i<sirenCount; i++){
+    int address = SIRENNODESADDRESS + 1 + i*2;
+    sirenNodes[i] = word(EEPROMQueue::read(address+1), EEPROMQueue::read(address));
+  }
+}
+
+
+
+//Writes the list of sirens to the EEPROM
+void Settings::saveSirenNodes()
+{
+  EEPROMQueue::write(SIRENNODESADDRESS, sirenCount);
+  for (int i=0; i<sirenCount; i++){
+    int address = SIRENNODESADDRESS + 1 + i*2;
+    EEPROMQueue::write(address, lowByte(sirenNodes[i]));
+    EEPROMQueue::write(address+1, highByte(sirenNodes[i]));
+  }
 }
 
 
@@ -172,17 +420,29 @@ void Settings::RestoreFactorySettings()
    //Backlight mode: default mode is 'Always On'
    setBacklightMode(0);
    
+   //Alerts only go to the original Buzzer Node
+   sirenCount = 1;
+   sirenNodes[0] = DEFAULTSIRENNODE;
+   saveSirenNodes();
+   
+   //Delete all passcodes. Only occupied slots are erased, to save EEPROM writes
+   while (storedCount > 0) deletePasscode(storedCount-1);
+   
    //Set factory included passcodes to whatever you want
-   byte passcodes[PASSCODELENGTH*MAXSTOREDPASSCODES] = {1,2,3,4,5,6,  195,136,150,198,0,0,  0,0,0,0,0,0,   0,0,0,0,0,0,   0,0,0,0,0,0,   0,0,0,0,0,0,  0,0,0,0,0,0,   0,0,0,0,0,0,  0,0,0,0,0,0,   0,0,0,0,0,0};
-   EEPROM.put(100, passcodes);
+   byte factoryPasscodes[][PASSCODELENGTH] = {{1,2,3,4,5,6},  {195,136,150,198,0,0}};
+   for (unsigned int i=0; i<sizeof(factoryPasscodes)/PASSCODELENGTH; i++) addNewPasscode(factoryPasscodes[i]);
 }
 
 
 /*
 Used only for debugging
-Write a 0 to all 1024 bytes of the EEPROM. Do not abuse this function. Every bit in 
+Write a 0 to all the bytes of the EEPROM used by the settings. Do not abuse this function. Every bit in 
 the EEPROM has a finite number of writes. Try to clear only those bits that actually store data.
 */
 void Settings::EEPROM_clear(){
-  for (int i = 0; i < 1024; i++) EEPROM.write(i, 0);
+  EEPROMQueue::flush();  //Or pending writes would land after the clear
+  for (int i = 0; i < PASSCODESADDRESS + MAXSTOREDPASSCODES*PASSCODELENGTH; i++) EEPROM.write(i, 0);
+  for (int i = 0; i < MAXSTOREDPASSCODES*PASSCODELENGTH; i++) passcodeStorage->write(passcodesAddress + i, 0);
+  passcodeStorage->flush();
+  begin();  //Reload the RAM copy
 }
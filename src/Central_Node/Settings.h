@@ -5,10 +5,21 @@
   
   Its main function is allowing to read and write settings in permanent memory (EEPROM) so that they can 
   be recovered after the Arduino is powered down. It uses static methods, so it is not necessary to create
-  an instance of Settings. Current settings implemented:
+  an instance of Settings. 
+  All settings are loaded into RAM by begin() and read from there afterwards, since they are consulted in every 
+  frame and for every alert. Changes are written both to RAM and to the EEPROM (write-through), so only writes 
+  touch the slow EEPROM, and even those go through EEPROMQueue so that they don't block. Settings that change 
+  often (alarm state and backlight mode) are stored in a wear-leveled log (see SettingsLog.h) instead of at a 
+  fixed address. The passcode database can be moved out of the internal EEPROM to any StorageBackend (an external 
+  FRAM chip, for example) with setPasscodeStorage(). Current settings implemented:
    - Alarm On/Off
    - Backlight mode
    - List of stored passcodes   
+   - List of siren (Buzzer) nodes that alerts are sent to
+  
+  Passcodes are stored in numbered slots. To keep verification fast with hundreds of users, a sorted index of 
+  the occupied slots is kept in RAM (lookups are a binary search), together with a bitmap of the free slots. 
+  Public methods refer to stored passcodes by their position in that sorted list, not by their slot.
 */
 
 
@@ -18,16 +29,29 @@
 
 #include "Arduino.h"  //Needed to recognize 'byte'.
 #include <EEPROM.h>
+#include "EEPROMQueue.h"
+#include "StorageBackend.h"
+#include "SettingsLog.h"
+#include "Log.h"
 
 
 const int PASSCODELENGTH = 6;
-const int MAXSTOREDPASSCODES = 10;
+static_assert(PASSCODELENGTH == 6, "Log messages print passcodes as 6 numbers");
+const int MAXSTOREDPASSCODES = 200;  //Slots are numbered with a byte, so this can't go above 255
+static_assert(MAXSTOREDPASSCODES <= 255, "Passcode slots are numbered with a byte");
+const int MAXSIRENNODES = 4;
+const uint16_t DEFAULTSIRENNODE = 2;  //The original Buzzer Node
+
 
 class Settings
 {
   public:
     
     Settings();
+    static void setPasscodeStorage(StorageBackend& storage, unsigned long address);
+    static void begin();
+    static void update();
+    static void flush();
     
     static void setAlarmState(bool);
     static bool isAlarmActivated();
@@ -36,20 +60,51 @@ class Settings
     static void addNewPasscode(byte passcode[PASSCODELENGTH]);
     static void deletePasscode(int index);
     static byte* getStoredPasscode(int index);
+    static int getStoredPasscodeCount();
     
     static void setBacklightMode(byte mode);
     static byte getBacklightMode();
     
+    static int getSirenCount();
+    static uint16_t getSirenNode(int index);
+    static bool addSirenNode(uint16_t node);
+    static bool removeSirenNode(uint16_t node);
+    
     static void RestoreFactorySettings();
     
     
     
   private:
   
+    ////RAM copy of the settings stored in the EEPROM
+    static bool alarmActivated;
+    static byte backlightMode;
+    static byte passcodes[MAXSTOREDPASSCODES][PASSCODELENGTH];
+    static uint16_t sirenNodes[MAXSIRENNODES];
+    static uint8_t sirenCount;
+    
+    ////Where the passcode database is stored permanently
+    static StorageBackend* passcodeStorage;
+    static unsigned long passcodesAddress;
+    
+    ////Index over the passcode slots
+    static uint8_t sortedSlots[MAXSTOREDPASSCODES];  //Occupied slots, sorted by their passcode
+    static int storedCount;  //Number of entries in sortedSlots
+    static byte usedSlots[(MAXSTOREDPASSCODES+7)/8];  //Bit set: slot occupied
+  
     static bool comparePasscodes(byte passcode1[PASSCODELENGTH], byte passcode2[PASSCODELENGTH]);    
-    static bool isPositionEmpty(int index);
+    static bool isPositionEmpty(int slot);
+    static bool isEmptyPasscode(byte passcode[PASSCODELENGTH]);
+    
+    static int findPasscode(byte passcode[PASSCODELENGTH], bool& found);
+    static int findFreeSlot();
+    static void markSlot(int slot, bool used);
+    static void writeSlot(int slot, byte passcode[PASSCODELENGTH]);
+    static void buildIndex();
+    
+    static void loadSirenNodes();
+    static void saveSirenNodes();
     
-    static byte* emptyPasscode();
     static void printStoredPasscodes();
     
     static void EEPROM_clear();
@@ -0,0 +1,147 @@
+#include "SettingsLog.h"
+
+
+//Location of the ring of records in the EEPROM. It goes from 1400 to 1719
+const int LOGADDRESS = 1400;
+const int LOGRECORDS = 64;
+const int RECORDSIZE = 5;  //Sequence number (2 bytes), key, value and check byte
+
+const uint16_t ERASEDSEQUENCE = 0xFFFF;  //What an erased EEPROM reads as. Never used as a sequence number
+
+int SettingsLog::newest;
+uint16_t SettingsLog::sequence;
+byte SettingsLog::values[NUMLOGKEYS];
+bool SettingsLog::found[NUMLOGKEYS];
+int SettingsLog::latest[NUMLOGKEYS];
+
+
+
+/*
+Finds the newest record and recovers the latest value of each setting. Must be called once at startup.
+The newest record is the last one of the run of consecutive sequence numbers. From there, the ring is walked 
+backwards until every setting has been found.
+*/
+void SettingsLog::begin()
+{
+  newest = -1;
+  for (int i=0; i<NUMLOGKEYS; i++) found[i] = false;
+  
+  //Find the newest record
+  Record record;
+  for (int position=0; position<LOGRECORDS; position++){
+    if (!readRecord(position, record)) continue;
+    
+    Record next;
+    bool nextFollows = readRecord((position+1) % LOGRECORDS, next) && (next.sequence == nextSequence(record.sequence));
+    if (!nextFollows){
+      newest = position;
+      sequence = record.sequence;
+      break;
+    }
+  }
+  if (newest < 0) return;  //Nothing has been logged yet
+  
+  //Walk backwards to get the latest value of each setting
+  int missing = NUMLOGKEYS;
+  for (int i=0; (i<LOGRECORDS) && (missing>0); i++){
+    int position = (newest - i + LOGRECORDS) % LOGRECORDS;
+    if (!readRecord(position, record) || (record.key >= NUMLOGKEYS) || found[record.key]) continue;
+    values[record.key] = record.value;
+    found[record.key] = true;
+    latest[record.key] = position;
+    missing--;
+  }
+}
+
+
+
+//Gets the latest value logged for a setting. Returns false if it has never been logged
+bool SettingsLog::read(SettingsLogKey key, byte& value)
+{
+  if (!found[key]) return(false);
+  value = values[key];
+  return(true);
+}
+
+
+
+/*
+Appends a new value for a setting to the log. Nothing is written if the value is the same as the latest one.
+If the next position of the ring holds the latest record of another setting, that setting is appended again first, 
+so that its value is not lost when the record is overwritten.
+*/
+void SettingsLog::write(SettingsLogKey key, byte value)
+{
+  if (found[key] && (values[key] == value)) return;
+  
+  bool moved = true;
+  while (moved){
+    moved = false;
+    int next = (newest + 1) % LOGRECORDS;
+    for (int other=0; other<NUMLOGKEYS; other++){
+      if ((other != key) && found[other] && (latest[other] == next)){
+        append((SettingsLogKey)other, values[other]);
+        moved = true;
+      }
+    }
+  }
+  
+  append(key, value);
+}
+
+
+
+//Writes a new record at the next position of the ring
+void SettingsLog::append(SettingsLogKey key, byte value)
+{
+  Record record;
+  sequence = (newest < 0) ? 0 : nextSequence(sequence);
+  newest = (newest + 1) % LOGRECORDS;
+  record.sequence = sequence;
+  record.key = key;
+  record.value = value;
+  record.check = checkByte(record);
+  
+  int address = LOGADDRESS + newest*RECORDSIZE;
+  EEPROMQueue::write(address, lowByte(record.sequence));
+  EEPROMQueue::write(address+1, highByte(record.sequence));
+  EEPROMQueue::write(address+2, record.key);
+  EEPROMQueue::write(address+3, record.value);
+  EEPROMQueue::write(address+4, record.check);
+  
+  values[key] = value;
+  found[key] = true;
+  latest[key] = newest;
+}
+
+
+
+//Reads the record at the given position of the ring. Returns false if it is erased or corrupt
+bool SettingsLog::readRecord(int position, Record& record)
+{
+  int address = LOGADDRESS + position*RECORDSIZE;
+  record.sequence = word(EEPROMQueue::read(address+1), EEPROMQueue::read(address));
+  record.key = EEPROMQueue::read(address+2);
+  record.value = EEPROMQueue::read(address+3);
+  record.check = EEPROMQueue::read(address+4);
+  
+  return((record.sequence != ERASEDSEQUENCE) && (record.check == checkByte(record)));
+}
+
+
+
+//Check byte of a record. Chosen so that an erased record (all 0xFF) or a zeroed one never passes
+byte SettingsLog::checkByte(const Record& record)
+{
+  return(0xA5 ^ lowByte(record.sequence) ^ highByte(record.sequence) ^ record.key ^ record.value);
+}
+
+
+
+//Sequence numbers wrap around, skipping the one used to mark erased records
+uint16_t SettingsLog::nextSequence(uint16_t sequence)
+{
+  sequence++;
+  if (sequence == ERASEDSEQUENCE) sequence = 0;
+  return(sequence);
+}
@@ -0,0 +1,67 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This library has been made for the final project of my career, an Arduino Smart Alarm. You may reuse all or part 
+  of the included code freely for non-commercial purposes.
+  
+  Wear-leveled storage in EEPROM for settings that change often, like the alarm state (written every time the alarm 
+  is armed or disarmed). Writing them always to the same address would wear out that EEPROM cell (each one lasts 
+  about 100,000 writes). Instead, every change is appended as a new record to a ring of records, so the writes are 
+  spread over the whole ring. Each record holds:
+   - A sequence number, which increases with every record. The newest record is found at startup by looking for 
+     the point where the sequence numbers stop being consecutive.
+   - The key of the setting (see SettingsLogKey) and its new value.
+   - A check byte, so that records left half-written by a power loss are ignored.
+  When the ring wraps around, the latest value of every other setting is appended again before its last record 
+  would be overwritten, so a setting that rarely changes is never lost to one that changes often.
+  Like Settings, it uses static methods, so it is not necessary to create an instance.
+*/
+
+#ifndef SettLog_h
+#define SettLog_h
+
+
+#include "Arduino.h"
+#include "EEPROMQueue.h"
+
+
+enum SettingsLogKey
+{
+  LOGKEY_ALARMSTATE,
+  LOGKEY_BACKLIGHTMODE,
+  NUMLOGKEYS
+};
+
+
+class SettingsLog
+{
+  public:
+    
+    static void begin();
+    static bool read(SettingsLogKey key, byte& value);
+    static void write(SettingsLogKey key, byte value);
+    
+    
+  private:
+  
+    struct Record
+    {
+      uint16_t sequence;
+      byte key;
+      byte value;
+      byte check;
+    };
+    
+    static int newest;  //Position in the ring of the newest record (-1: the log is empty)
+    static uint16_t sequence;  //Sequence number of the newest record
+    static byte values[NUMLOGKEYS];  //Latest value of each setting
+    static bool found[NUMLOGKEYS];  //Whether the log contains a value for each setting
+    static int latest[NUMLOGKEYS];  //Position in the ring of the latest record of each setting
+    
+    static void append(SettingsLogKey key, byte value);
+    static bool readRecord(int position, Record& record);
+    static byte checkByte(const Record& record);
+    static uint16_t nextSequence(uint16_t sequence);
+};
+
+
+#endif
@@ -8,7 +8,7 @@
   accordingly to increase minutes, save changes, etc.
 
   Not that this only deals with the backend logic of the FSM. The LCD display is performed by the Display class after 
-  consulting the current state of the FSM.
+  consulting the current state of the FSM. The states and what each one does are declared in the menu table (Menu.h).
 */
 
 
@@ -18,9 +18,13 @@
 #ifndef StateMach_h
 #define StateMach_h
 
-#include "analogKeyboard.h"
+#include "AnalogKeyboard.h"
 #include "Settings.h"
-#include <RTClib.h>
+#include "Menu.h"
+#include "ClockService.h"
+
+
+const unsigned long YEARFASTHOLDTIME = 3000;  //Milliseconds Up or Down must be held to change the year in steps of ten
 
 
 class StateMachine{
@@ -28,9 +32,9 @@ class StateMachine{
   public:
   
     StateMachine();
-    void update(AnalogKeyboard analogKeyboard, RTC_DS1307 clock);
-    int GetState();
-    int GetCursorPosition();
+    void update(const AnalogKeyboard& analogKeyboard, ClockService& clock);
+    int GetState() const;
+    int GetCursorPosition() const;
     
     //Temporal values used while changing time and date (they appear on the screen but aren't really saved until the user says so)
     uint8_t tempMinute;
@@ -41,10 +45,29 @@ class StateMachine{
     
     
   private:
+    
+    friend class Menu;  //The menu table points to the methods that handle each state
 
     ////State machine navigation variables
-    int state;  //The current state of the state machine
+    int state;  //The current state of the state machine (see MenuState in Menu.h)
     int cursorPosition;  //Some states are lists of entries. This keeps track of which one is seleted
+    
+    void enterMenu(uint8_t newState, ClockService& clock);
+    bool moveCursor(const MenuEntry& menu, const AnalogKeyboard& analogKeyboard);
+    
+    ////Handlers of each state (see Menu.cpp)
+    void inputMainScreen(const AnalogKeyboard& analogKeyboard, ClockService& clock);
+    void inputMenuRoot(const AnalogKeyboard& analogKeyboard, ClockService& clock);
+    void enterTimeSelection(ClockService& clock);
+    void inputTimeSelection(const AnalogKeyboard& analogKeyboard, ClockService& clock);
+    void enterDateSelection(ClockService& clock);
+    void inputDateSelection(const AnalogKeyboard& analogKeyboard, ClockService& clock);
+    void inputAddPasscode(const AnalogKeyboard& analogKeyboard, ClockService& clock);
+    void inputDeletePasscode(const AnalogKeyboard& analogKeyboard, ClockService& clock);
+    void inputBacklightMode(const AnalogKeyboard& analogKeyboard, ClockService& clock);
+    void inputFactoryReset(const AnalogKeyboard& analogKeyboard, ClockService& clock);
+    
+    static int YearStep(const AnalogButton& button);
   
 
 };
@@ -0,0 +1,52 @@
+#include "StorageBackend.h"
+
+
+//Reads several consecutive bytes. Backends that can read faster in blocks override this
+void StorageBackend::readBlock(unsigned long address, byte* data, unsigned int length)
+{
+  for (unsigned int i = 0; i < length; i++) data[i] = read(address + i);
+}
+
+
+
+//Writes several consecutive bytes. Backends that can write faster in blocks override this
+void StorageBackend::writeBlock(unsigned long address, const byte* data, unsigned int length)
+{
+  for (unsigned int i = 0; i < length; i++) write(address + i, data[i]);
+}
+
+
+
+////////////////////////////////////////////////////////////////////////
+////EEPROMStorage: the ATmega's internal EEPROM
+////////////////////////////////////////////////////////////////////////
+
+byte EEPROMStorage::read(unsigned long address)
+{
+  return(EEPROMQueue::read(address));
+}
+
+
+void EEPROMStorage::write(unsigned long address, byte value)
+{
+  EEPROMQueue::write(address, value);
+}
+
+
+//Writes one pending byte, if the EEPROM is ready for it
+void EEPROMStorage::update()
+{
+  EEPROMQueue::update();
+}
+
+
+void EEPROMStorage::flush()
+{
+  EEPROMQueue::flush();
+}
+
+
+unsigned long EEPROMStorage::size()
+{
+  return(EEPROM.length());
+}
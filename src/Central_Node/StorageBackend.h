@@ -0,0 +1,51 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This library has been made for the final project of my career, an Arduino Smart Alarm. You may reuse all or part 
+  of the included code freely for non-commercial purposes.
+  
+  Common interface for the permanent memories where the Central Node can keep its data (for now, the passcode 
+  database). Settings only talks to this interface, so the data can live in the ATmega's own EEPROM, in an external 
+  memory chip (see FRAMStorage.h), or in a file when running on a computer (see host/MappedFileStorage.h).
+  Writes may be buffered by the backend: update() must be called regularly so it can do its background work, and 
+  flush() forces everything out. Reads always return the latest data written, buffered or not.
+  
+  EEPROMStorage, the backend for the internal EEPROM, is also declared here. Its writes go through EEPROMQueue.
+*/
+
+#ifndef Storage_h
+#define Storage_h
+
+
+#include "Arduino.h"
+#include "EEPROMQueue.h"
+
+
+class StorageBackend
+{
+  public:
+  
+    virtual byte read(unsigned long address) = 0;
+    virtual void write(unsigned long address, byte value) = 0;
+    virtual void readBlock(unsigned long address, byte* data, unsigned int length);
+    virtual void writeBlock(unsigned long address, const byte* data, unsigned int length);
+    
+    virtual void update() {}
+    virtual void flush() {}
+    virtual unsigned long size() = 0;
+};
+
+
+
+class EEPROMStorage : public StorageBackend
+{
+  public:
+  
+    virtual byte read(unsigned long address);
+    virtual void write(unsigned long address, byte value);
+    virtual void update();
+    virtual void flush();
+    virtual unsigned long size();
+};
+
+
+#endif
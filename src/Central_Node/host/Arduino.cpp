@@ -0,0 +1,184 @@
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+
+#include "Arduino.h"
+
+
+HostSerial Serial;
+
+static int pinValues[NUM_HOST_PINS];
+
+
+
+////Pins
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  if (pin < NUM_HOST_PINS && mode == INPUT_PULLUP) pinValues[pin] = HIGH;
+}
+
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+  if (pin < NUM_HOST_PINS) pinValues[pin] = value;
+}
+
+
+int digitalRead(uint8_t pin)
+{
+  return(pin < NUM_HOST_PINS ? pinValues[pin] : LOW);
+}
+
+
+//Floating analog pins read as 1023, which is what the resistor ladder keyboard reads with no key pressed
+int analogRead(uint8_t pin)
+{
+  static bool initialized = false;
+  if (!initialized){
+    for (int i = A0; i < NUM_HOST_PINS; i++) pinValues[i] = 1023;
+    initialized = true;
+  }
+  return(pin < NUM_HOST_PINS ? pinValues[pin] : 0);
+}
+
+
+void analogWrite(uint8_t pin, int value)
+{
+  digitalWrite(pin, value);
+}
+
+
+void hostSetAnalog(uint8_t pin, int value)
+{
+  analogRead(pin);  //Make sure the defaults are in place before overriding one of them
+  if (pin < NUM_HOST_PINS) pinValues[pin] = value;
+}
+
+
+void hostSetDigital(uint8_t pin, int value)
+{
+  if (pin < NUM_HOST_PINS) pinValues[pin] = value;
+}
+
+
+
+////Interrupts. The host has no external interrupt sources, so these are accepted and ignored
+
+int digitalPinToInterrupt(uint8_t pin)
+{
+  return(pin);
+}
+
+void attachInterrupt(uint8_t interrupt, void (*isr)(), int mode)
+{
+  (void)interrupt; (void)isr; (void)mode;
+}
+
+void detachInterrupt(uint8_t interrupt)
+{
+  (void)interrupt;
+}
+
+void noInterrupts() {}
+void interrupts() {}
+
+
+
+////Time
+
+static uint64_t hostMicros()
+{
+  static uint64_t start = 0;
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  uint64_t now = (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+  if (start == 0) start = now;
+  return(now - start);
+}
+
+
+unsigned long millis()
+{
+  return((unsigned long)(uint32_t)(hostMicros() / 1000));
+}
+
+
+//Truncated to 32 bits so that overflow behaves as on the ATmega
+unsigned long micros()
+{
+  return((unsigned long)(uint32_t)hostMicros());
+}
+
+
+void delay(unsigned long ms)
+{
+  usleep(ms * 1000);
+}
+
+
+void delayMicroseconds(unsigned int us)
+{
+  usleep(us);
+}
+
+
+
+////Print
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+  size_t n = 0;
+  while (size--) n += write(*buffer++);
+  return(n);
+}
+
+
+size_t Print::print(long n, int base)
+{
+  if (n < 0 && base == DEC){
+    size_t t = print('-');
+    return(t + print((unsigned long)(-n), base));
+  }
+  return(print((unsigned long)n, base));
+}
+
+
+size_t Print::print(unsigned long n, int base)
+{
+  char buf[8 * sizeof(long) + 1];
+  char* str = &buf[sizeof(buf) - 1];
+  *str = '\0';
+  if (base < 2) base = 10;
+  do {
+    unsigned long digit = n % base;
+    *--str = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    n /= base;
+  } while (n);
+  return(write(str));
+}
+
+
+
+////Serial
+
+size_t HostSerial::write(uint8_t c)
+{
+  putchar(c);
+  return(1);
+}
+
+
+int HostSerial::available()
+{
+  struct pollfd fd = {0, POLLIN, 0};
+  return(poll(&fd, 1, 0) > 0 && (fd.revents & POLLIN) ? 1 : 0);
+}
+
+
+int HostSerial::read()
+{
+  if (!available()) return(-1);
+  unsigned char c;
+  return(::read(0, &c, 1) == 1 ? c : -1);
+}
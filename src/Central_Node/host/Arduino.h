@@ -0,0 +1,155 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This code has been developed for the final project of my career, an Arduino Smart Alarm. You may reuse all or part
+  of the included code freely for non-commercial purposes.
+
+  Host stand-in for the Arduino core. Together with the other headers in this folder it forms a thin hardware
+  abstraction layer: the Central Node sources include the same headers they use on the ATmega, and on Linux they
+  resolve to these implementations instead. Only the subset of the core actually used by the Central Node is provided.
+   - Time (millis, micros, delay) comes from the host's monotonic clock.
+   - Pins are kept in RAM. Analog inputs can be set from the host with hostSetAnalog().
+   - Serial writes to stdout and reads from stdin without blocking.
+   - Flash (PROGMEM) is ordinary memory, so the *_P functions map to their RAM versions.
+*/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+
+#include "binary.h"
+
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+
+////Pins
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define A0 54
+#define A1 55
+#define A2 56
+#define A3 57
+
+#define NUM_HOST_PINS 70
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+
+int digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(uint8_t interrupt, void (*isr)(), int mode);
+void detachInterrupt(uint8_t interrupt);
+void noInterrupts();
+void interrupts();
+
+//Host-only helpers to drive the inputs of the simulated board
+void hostSetAnalog(uint8_t pin, int value);
+void hostSetDigital(uint8_t pin, int value);
+
+
+////Time
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+
+////Math helpers
+#define PI 3.1415926535897932384626433832795
+#define bit(b) (1UL << (b))
+#define lowByte(w) ((uint8_t)((w) & 0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+#define word(h, l) ((uint16_t)(((h) << 8) | (l)))
+
+#ifndef min
+#define min(a,b) ((a)<(b)?(a):(b))
+#endif
+#ifndef max
+#define max(a,b) ((a)>(b)?(a):(b))
+#endif
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+
+
+////Flash memory. On the host everything lives in RAM
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_ptr(addr) (*(void* const*)(addr))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strcmp_P strcmp
+#define printf_P printf
+#define sprintf_P sprintf
+#define snprintf_P snprintf
+#define vsnprintf_P vsnprintf
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+
+
+////Print: base class of everything that outputs text (Serial, LiquidCrystal...)
+#define DEC 10
+#define HEX 16
+
+class Print
+{
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* str) { return(str ? write((const uint8_t*)str, strlen(str)) : 0); }
+    virtual int availableForWrite() { return(0); }
+
+    size_t print(const __FlashStringHelper* str) { return(print(reinterpret_cast<const char*>(str))); }
+    size_t print(const char* str) { return(write(str)); }
+    size_t print(char c) { return(write((uint8_t)c)); }
+    size_t print(unsigned char n, int base = DEC) { return(print((unsigned long)n, base)); }
+    size_t print(int n, int base = DEC) { return(print((long)n, base)); }
+    size_t print(unsigned int n, int base = DEC) { return(print((unsigned long)n, base)); }
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+
+    size_t println() { return(write("\r\n")); }
+    template <class T> size_t println(T value) { size_t n = print(value); return(n + println()); }
+};
+
+
+////Serial: stdout/stdin of the host process
+class HostSerial : public Print
+{
+  public:
+    void begin(unsigned long baud) { (void)baud; }
+    int available();
+    int read();
+    void flush() { fflush(stdout); }
+    size_t write(uint8_t c);
+    using Print::write;
+    int availableForWrite() { return(64); }
+    operator bool() { return(true); }
+};
+
+extern HostSerial Serial;
+
+
+#endif
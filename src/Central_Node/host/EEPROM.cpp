@@ -0,0 +1,70 @@
+#include "EEPROM.h"
+
+
+EEPROMClass EEPROM;
+
+
+
+//Loads the EEPROM image from its backing file, or starts with an erased chip if there is none
+EEPROMClass::EEPROMClass()
+{
+  writeCount = 0;
+  load();
+}
+
+
+static const char* backingFile()
+{
+  const char* path = getenv("EEPROM_FILE");
+  return(path ? path : "eeprom.bin");
+}
+
+
+void EEPROMClass::load()
+{
+  memset(cells, 0xFF, sizeof(cells));
+  FILE* file = fopen(backingFile(), "rb");
+  if (!file) return;
+  size_t n = fread(cells, 1, sizeof(cells), file);
+  (void)n;
+  fclose(file);
+}
+
+
+//Writes a single cell back to the file, so that a crash loses no more than the real chip would
+void EEPROMClass::store(int address)
+{
+  FILE* file = fopen(backingFile(), "r+b");
+  if (!file){
+    file = fopen(backingFile(), "w+b");
+    if (!file) return;
+    fwrite(cells, 1, sizeof(cells), file);
+    fclose(file);
+    return;
+  }
+  fseek(file, address, SEEK_SET);
+  fputc(cells[address], file);
+  fclose(file);
+}
+
+
+uint8_t EEPROMClass::read(int address)
+{
+  if (address < 0 || address > E2END) return(0xFF);
+  return(cells[address]);
+}
+
+
+void EEPROMClass::write(int address, uint8_t value)
+{
+  if (address < 0 || address > E2END) return;
+  cells[address] = value;
+  writeCount++;
+  store(address);
+}
+
+
+void EEPROMClass::update(int address, uint8_t value)
+{
+  if (read(address) != value) write(address, value);
+}
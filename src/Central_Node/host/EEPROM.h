@@ -0,0 +1,58 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This code has been developed for the final project of my career, an Arduino Smart Alarm. You may reuse all or part
+  of the included code freely for non-commercial purposes.
+
+  Host stand-in for the Arduino EEPROM library. The 4 KB of the ATmega2560's EEPROM are kept in RAM and mirrored
+  to a file (eeprom.bin in the working directory, or the path in the EEPROM_FILE environment variable) so that
+  settings survive between runs, just like on the real board. Unwritten cells read as 0xFF, as on a new chip.
+*/
+
+#ifndef EEPROM_h
+#define EEPROM_h
+
+#include "Arduino.h"
+
+
+#define E2END 0xFFF
+
+
+class EEPROMClass
+{
+  public:
+    EEPROMClass();
+
+    uint8_t read(int address);
+    void write(int address, uint8_t value);
+    void update(int address, uint8_t value);
+    uint16_t length() { return(E2END + 1); }
+
+    template <class T> T& get(int address, T& value)
+    {
+      uint8_t* p = (uint8_t*)(void*)&value;
+      for (unsigned int i = 0; i < sizeof(T); i++) *p++ = read(address++);
+      return(value);
+    }
+
+    template <class T> const T& put(int address, const T& value)
+    {
+      const uint8_t* p = (const uint8_t*)(const void*)&value;
+      for (unsigned int i = 0; i < sizeof(T); i++) update(address++, *p++);
+      return(value);
+    }
+
+    unsigned long getWriteCount() { return(writeCount); }
+
+
+  private:
+    uint8_t cells[E2END + 1];
+    unsigned long writeCount;  //Number of physical byte writes, to study wear and write stalls
+
+    void load();
+    void store(int address);
+};
+
+extern EEPROMClass EEPROM;
+
+
+#endif
@@ -0,0 +1,73 @@
+#include "LiquidCrystal.h"
+
+
+LiquidCrystal* LiquidCrystal::hostInstance = NULL;
+
+
+
+LiquidCrystal::LiquidCrystal(uint8_t rs, uint8_t enable, uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7)
+{
+  (void)rs; (void)enable; (void)d4; (void)d5; (void)d6; (void)d7;
+  cols = HOST_LCD_COLS;
+  rows = HOST_LCD_ROWS;
+  busOperations = 0;
+  clear();
+  hostInstance = this;
+}
+
+
+void LiquidCrystal::begin(uint8_t myCols, uint8_t myRows)
+{
+  cols = myCols < HOST_LCD_COLS ? myCols : HOST_LCD_COLS;
+  rows = myRows < HOST_LCD_ROWS ? myRows : HOST_LCD_ROWS;
+  clear();
+}
+
+
+void LiquidCrystal::clear()
+{
+  memset(cells, ' ', sizeof(cells));
+  col = row = 0;
+  busOperations++;
+}
+
+
+void LiquidCrystal::home()
+{
+  col = row = 0;
+  busOperations++;
+}
+
+
+//Like the real library, rows beyond the last one are clamped to the last one
+void LiquidCrystal::setCursor(uint8_t myCol, uint8_t myRow)
+{
+  if (myRow >= rows) myRow = rows - 1;
+  col = myCol;
+  row = myRow;
+  busOperations++;
+}
+
+
+void LiquidCrystal::createChar(uint8_t location, uint8_t charmap[])
+{
+  (void)location; (void)charmap;
+  busOperations += 9;  //Set CGRAM address and eight rows
+}
+
+
+size_t LiquidCrystal::write(uint8_t value)
+{
+  if (col < cols) cells[row][col] = (value < 9 || value > 126) ? '#' : value;
+  col++;
+  busOperations++;
+  return(1);
+}
+
+
+void LiquidCrystal::hostDump()
+{
+  printf("+--------------------+\n");
+  for (uint8_t r = 0; r < rows; r++) printf("|%.*s|\n", cols, cells[r]);
+  printf("+--------------------+\n");
+}
@@ -0,0 +1,49 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This code has been developed for the final project of my career, an Arduino Smart Alarm. You may reuse all or part
+  of the included code freely for non-commercial purposes.
+
+  Host stand-in for the LiquidCrystal library. It keeps the contents of the HD44780's display RAM as text and
+  counts every command and character sent, which is what costs bus time on the real screen. hostDump() prints
+  the screen to stdout. Custom characters (codes 0-7) are shown as '#'.
+*/
+
+#ifndef LiquidCrystal_h
+#define LiquidCrystal_h
+
+#include "Arduino.h"
+
+
+#define HOST_LCD_COLS 20
+#define HOST_LCD_ROWS 4
+
+
+class LiquidCrystal : public Print
+{
+  public:
+    LiquidCrystal(uint8_t rs, uint8_t enable, uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7);
+
+    void begin(uint8_t cols, uint8_t rows);
+    void clear();
+    void home();
+    void setCursor(uint8_t col, uint8_t row);
+    void createChar(uint8_t location, uint8_t charmap[]);
+    size_t write(uint8_t value);
+    using Print::write;
+
+    void hostDump();
+    unsigned long hostBusOperations() { return(busOperations); }
+    static LiquidCrystal* hostInstance;  //Last screen constructed, so the host program can look at it
+
+
+  private:
+    char cells[HOST_LCD_ROWS][HOST_LCD_COLS];
+    uint8_t cols;
+    uint8_t rows;
+    uint8_t col;
+    uint8_t row;
+    unsigned long busOperations;
+};
+
+
+#endif
@@ -0,0 +1,72 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MappedFileStorage.h"
+
+
+
+//Opens (or creates) the file and maps it. A new file, or the part that extends an existing one, reads as 0xFF
+MappedFileStorage::MappedFileStorage(const char* path, unsigned long mySize)
+{
+  memory = NULL;
+  capacity = mySize;
+
+  int fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0) return;
+
+  struct stat info;
+  unsigned long oldSize = (fstat(fd, &info) == 0) ? info.st_size : 0;
+  if ((oldSize < capacity) && (ftruncate(fd, capacity) != 0)){
+    close(fd);
+    return;
+  }
+
+  void* mapping = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);  //The mapping stays valid
+  if (mapping == MAP_FAILED) return;
+
+  memory = (byte*)mapping;
+  if (oldSize < capacity) memset(memory + oldSize, 0xFF, capacity - oldSize);
+}
+
+
+MappedFileStorage::~MappedFileStorage()
+{
+  if (!memory) return;
+  flush();
+  munmap(memory, capacity);
+}
+
+
+byte MappedFileStorage::read(unsigned long address)
+{
+  return((memory && address < capacity) ? memory[address] : 0xFF);
+}
+
+
+void MappedFileStorage::write(unsigned long address, byte value)
+{
+  if (memory && address < capacity) memory[address] = value;
+}
+
+
+void MappedFileStorage::readBlock(unsigned long address, byte* data, unsigned int length)
+{
+  if (memory && address + length <= capacity) memcpy(data, memory + address, length);
+  else StorageBackend::readBlock(address, data, length);
+}
+
+
+void MappedFileStorage::writeBlock(unsigned long address, const byte* data, unsigned int length)
+{
+  if (memory && address + length <= capacity) memcpy(memory + address, data, length);
+  else StorageBackend::writeBlock(address, data, length);
+}
+
+
+void MappedFileStorage::flush()
+{
+  if (memory) msync(memory, capacity, MS_SYNC);
+}
@@ -0,0 +1,40 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This code has been developed for the final project of my career, an Arduino Smart Alarm. You may reuse all or part
+  of the included code freely for non-commercial purposes.
+
+  Storage backend for the native Linux build: a file mapped into memory with mmap(). Reads and writes are plain
+  memory accesses and the operating system writes the pages back to the file, so it behaves like a large and very
+  fast external memory. Useful to load-test the Central Node with big passcode databases.
+*/
+
+#ifndef MappedFileStorage_h
+#define MappedFileStorage_h
+
+#include "Arduino.h"
+#include "StorageBackend.h"
+
+
+class MappedFileStorage : public StorageBackend
+{
+  public:
+    MappedFileStorage(const char* path, unsigned long mySize);
+    ~MappedFileStorage();
+
+    bool isOpen() { return(memory != NULL); }
+
+    virtual byte read(unsigned long address);
+    virtual void write(unsigned long address, byte value);
+    virtual void readBlock(unsigned long address, byte* data, unsigned int length);
+    virtual void writeBlock(unsigned long address, const byte* data, unsigned int length);
+    virtual void flush();
+    virtual unsigned long size() { return(capacity); }
+
+
+  private:
+    byte* memory;
+    unsigned long capacity;
+};
+
+
+#endif
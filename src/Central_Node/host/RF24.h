@@ -0,0 +1,30 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This code has been developed for the final project of my career, an Arduino Smart Alarm. You may reuse all or part
+  of the included code freely for non-commercial purposes.
+
+  Host stand-in for the RF24 driver of the nRF24l01+ module. There is no radio on the host: RF24Network.h
+  keeps its frames in memory, so this class only has to exist.
+*/
+
+#ifndef RF24_h
+#define RF24_h
+
+#include "Arduino.h"
+
+
+class RF24
+{
+  public:
+    RF24(uint8_t cePin, uint8_t csnPin) : ce(cePin), csn(csnPin) {}
+    bool begin() { return(true); }
+    bool rxFifoFull() { return(false); }
+
+
+  private:
+    uint8_t ce;
+    uint8_t csn;
+};
+
+
+#endif
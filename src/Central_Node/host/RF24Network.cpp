@@ -0,0 +1,127 @@
+#include "RF24Network.h"
+
+
+uint16_t RF24NetworkHeader::nextId = 1;
+RF24Network* RF24Network::hostInstance = NULL;
+
+
+
+RF24Network::RF24Network(RF24& myRadio) : radio(myRadio)
+{
+  address = 0;
+  rxHead = rxCount = 0;
+  txHead = txCount = 0;
+  dropped = 0;
+  unreachableCount = 0;
+  hostInstance = this;
+}
+
+
+void RF24Network::begin(uint8_t channel, uint16_t nodeAddress)
+{
+  (void)channel;
+  address = nodeAddress;
+}
+
+
+uint8_t RF24Network::update()
+{
+  return(rxCount ? rxQueue[rxHead].header.type : 0);
+}
+
+
+bool RF24Network::available()
+{
+  return(rxCount > 0);
+}
+
+
+//Returns the header of the next frame without removing it, and the size of its payload
+uint16_t RF24Network::peek(RF24NetworkHeader& header)
+{
+  if (!rxCount) return(0);
+  header = rxQueue[rxHead].header;
+  return(rxQueue[rxHead].size);
+}
+
+
+//Takes the next frame out of the queue. Returns how many payload bytes were copied into message
+uint16_t RF24Network::read(RF24NetworkHeader& header, void* message, uint16_t maxLength)
+{
+  if (!rxCount) return(0);
+
+  RF24NetworkFrame& frame = rxQueue[rxHead];
+  header = frame.header;
+  uint16_t length = frame.size < maxLength ? frame.size : maxLength;
+  if (message && length) memcpy(message, frame.payload, length);
+
+  rxHead = (rxHead + 1) % HOST_NETWORK_QUEUE;
+  rxCount--;
+  return(length);
+}
+
+
+bool RF24Network::write(RF24NetworkHeader& header, const void* message, uint16_t length)
+{
+  header.from_node = address;
+  if (!isReachable(header.to_node) || length > MAX_PAYLOAD_SIZE) return(false);
+
+  if (txCount == HOST_NETWORK_QUEUE){  //Nobody is draining the sent frames. Forget the oldest one
+    txHead = (txHead + 1) % HOST_NETWORK_QUEUE;
+    txCount--;
+  }
+  RF24NetworkFrame& frame = txQueue[(txHead + txCount) % HOST_NETWORK_QUEUE];
+  frame.header = header;
+  frame.size = length;
+  if (message && length) memcpy(frame.payload, message, length);
+  txCount++;
+  return(true);
+}
+
+
+
+//Puts a frame in the receive queue as if it had arrived from node fromNode. Returns false if the queue is full
+bool RF24Network::hostInject(uint16_t fromNode, unsigned char type, const void* payload, uint16_t length)
+{
+  if (rxCount == HOST_NETWORK_QUEUE || length > MAX_PAYLOAD_SIZE){
+    dropped++;
+    return(false);
+  }
+  RF24NetworkFrame& frame = rxQueue[(rxHead + rxCount) % HOST_NETWORK_QUEUE];
+  frame.header = RF24NetworkHeader(address, type);
+  frame.header.from_node = fromNode;
+  frame.size = length;
+  if (payload && length) memcpy(frame.payload, payload, length);
+  rxCount++;
+  return(true);
+}
+
+
+//Takes the oldest frame written by the node. Returns false if there is none
+bool RF24Network::hostTakeSent(RF24NetworkFrame& frame)
+{
+  if (!txCount) return(false);
+  frame = txQueue[txHead];
+  txHead = (txHead + 1) % HOST_NETWORK_QUEUE;
+  txCount--;
+  return(true);
+}
+
+
+void RF24Network::hostSetReachable(uint16_t node, bool reachable)
+{
+  for (uint8_t i = 0; i < unreachableCount; i++){
+    if (unreachable[i] == node){
+      if (reachable) unreachable[i] = unreachable[--unreachableCount];
+      return;
+    }
+  }
+  if (!reachable && unreachableCount < 8) unreachable[unreachableCount++] = node;
+}
+
+
+bool RF24Network::isReachable(uint16_t node)
+{
+  for (uint8_t i = 0; i < unreachableCount; i++) if (unreachable[i] == node) return(false);
+  return(true);
+}
@@ -0,0 +1,87 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This code has been developed for the final project of my career, an Arduino Smart Alarm. You may reuse all or part
+  of the included code freely for non-commercial purposes.
+
+  Host stand-in for RF24Network. Incoming frames are held in an in-memory FIFO that the host program fills with
+  hostInject(), and outgoing frames are stored in a second FIFO that it can drain with hostTakeSent(). Whether
+  writes to a given node succeed can be chosen with hostSetReachable(), to simulate nodes that are powered off
+  or out of range.
+*/
+
+#ifndef RF24Network_h
+#define RF24Network_h
+
+#include "Arduino.h"
+#include "RF24.h"
+
+
+#define MAX_PAYLOAD_SIZE 144
+#define HOST_NETWORK_QUEUE 64
+
+
+struct RF24NetworkHeader
+{
+  uint16_t from_node;
+  uint16_t to_node;
+  uint16_t id;
+  unsigned char type;
+  unsigned char reserved;
+
+  RF24NetworkHeader() : from_node(0), to_node(0), id(0), type(0), reserved(0) {}
+  RF24NetworkHeader(uint16_t to, unsigned char myType = 0) : from_node(0), to_node(to), id(nextId++), type(myType), reserved(0) {}
+
+  static uint16_t nextId;
+};
+
+
+struct RF24NetworkFrame
+{
+  RF24NetworkHeader header;
+  uint16_t size;
+  uint8_t payload[MAX_PAYLOAD_SIZE];
+};
+
+
+class RF24Network
+{
+  public:
+    RF24Network(RF24& myRadio);
+
+    void begin(uint8_t channel, uint16_t nodeAddress);
+    uint8_t update();
+    bool available();
+    uint16_t peek(RF24NetworkHeader& header);
+    uint16_t read(RF24NetworkHeader& header, void* message, uint16_t maxLength);
+    bool write(RF24NetworkHeader& header, const void* message, uint16_t length);
+
+    ////Host side of the simulated air
+    bool hostInject(uint16_t fromNode, unsigned char type, const void* payload, uint16_t length);
+    bool hostTakeSent(RF24NetworkFrame& frame);
+    void hostSetReachable(uint16_t node, bool reachable);
+    uint8_t hostPending() { return(rxCount); }
+    unsigned long hostDropped() { return(dropped); }
+    static RF24Network* hostInstance;  //Last network constructed, so the host program can reach it
+
+
+  private:
+    RF24& radio;
+    uint16_t address;
+
+    RF24NetworkFrame rxQueue[HOST_NETWORK_QUEUE];
+    uint8_t rxHead;
+    uint8_t rxCount;
+    unsigned long dropped;
+
+    RF24NetworkFrame txQueue[HOST_NETWORK_QUEUE];
+    uint8_t txHead;
+    uint8_t txCount;
+
+    uint16_t unreachable[8];
+    uint8_t unreachableCount;
+
+    bool isReachable(uint16_t node);
+};
+
+
+#endif
@@ -0,0 +1,127 @@
+#include <time.h>
+
+#include "RTClib.h"
+
+
+static const uint8_t daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+
+
+//Number of days since 2000/01/01, valid for 2001..2099
+static uint16_t date2days(uint16_t y, uint8_t m, uint8_t d)
+{
+  if (y >= 2000) y -= 2000;
+  uint16_t days = d;
+  for (uint8_t i = 1; i < m; ++i) days += daysInMonth[i - 1];
+  if (m > 2 && y % 4 == 0) ++days;
+  return(days + 365 * y + (y + 3) / 4 - 1);
+}
+
+
+static uint8_t conv2d(const char* p)
+{
+  uint8_t v = 0;
+  if ('0' <= *p && *p <= '9') v = *p - '0';
+  return(10 * v + *++p - '0');
+}
+
+
+
+DateTime::DateTime(uint32_t t)
+{
+  t -= SECONDS_FROM_1970_TO_2000;
+
+  ss = t % 60;
+  t /= 60;
+  mm = t % 60;
+  t /= 60;
+  hh = t % 24;
+  uint16_t days = t / 24;
+  uint8_t leap;
+  for (yOff = 0;; ++yOff){
+    leap = yOff % 4 == 0;
+    if (days < 365 + leap) break;
+    days -= 365 + leap;
+  }
+  for (m = 1; m < 12; ++m){
+    uint8_t daysPerMonth = daysInMonth[m - 1];
+    if (leap && m == 2) ++daysPerMonth;
+    if (days < daysPerMonth) break;
+    days -= daysPerMonth;
+  }
+  d = days + 1;
+}
+
+
+DateTime::DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t min, uint8_t sec)
+{
+  if (year >= 2000) year -= 2000;
+  yOff = year;
+  m = month;
+  d = day;
+  hh = hour;
+  mm = min;
+  ss = sec;
+}
+
+
+//Parses the compiler's __DATE__ ("Apr 16 2015") and __TIME__ ("18:34:56")
+DateTime::DateTime(const char* date, const char* time)
+{
+  static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+  yOff = conv2d(date + 9);
+  m = 1;
+  for (uint8_t i = 0; i < 12; i++) if (strncmp(date, months + 3 * i, 3) == 0) m = i + 1;
+  d = conv2d(date + 4);
+  hh = conv2d(time);
+  mm = conv2d(time + 3);
+  ss = conv2d(time + 6);
+}
+
+
+uint8_t DateTime::dayOfTheWeek() const
+{
+  uint16_t day = date2days(yOff, m, d);
+  return((day + 6) % 7);  //Jan 1, 2000 is a Saturday
+}
+
+
+uint32_t DateTime::unixtime() const
+{
+  uint16_t days = date2days(yOff, m, d);
+  uint32_t t = ((days * 24UL + hh) * 60 + mm) * 60 + ss;
+  return(t + SECONDS_FROM_1970_TO_2000);
+}
+
+
+
+uint32_t RTC_DS1307::base = 0;
+unsigned long RTC_DS1307::baseMillis = 0;
+unsigned long RTC_DS1307::reads = 0;
+Ds1307SqwPinMode RTC_DS1307::sqwMode = OFF;
+
+
+bool RTC_DS1307::begin()
+{
+  if (base == 0){
+    time_t wallClock = ::time(NULL);
+    struct tm local;
+    localtime_r(&wallClock, &local);
+    adjust(DateTime(local.tm_year + 1900, local.tm_mon + 1, local.tm_mday, local.tm_hour, local.tm_min, local.tm_sec));
+  }
+  return(true);
+}
+
+
+void RTC_DS1307::adjust(const DateTime& dt)
+{
+  base = dt.unixtime();
+  baseMillis = millis();
+}
+
+
+DateTime RTC_DS1307::now()
+{
+  reads++;
+  return(DateTime(base + (millis() - baseMillis) / 1000));
+}
@@ -0,0 +1,81 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This code has been developed for the final project of my career, an Arduino Smart Alarm. You may reuse all or part
+  of the included code freely for non-commercial purposes.
+
+  Host stand-in for RTClib. DateTime follows the library (dates from 2000 to 2099), and RTC_DS1307 is a settable
+  clock that runs from the host's monotonic time. It starts at the host's wall-clock time; adjust() sets it like
+  on the real chip. Every call to now() is counted, since on the board each one is an I2C transaction.
+*/
+
+#ifndef RTClib_h
+#define RTClib_h
+
+#include "Arduino.h"
+
+
+#define SECONDS_FROM_1970_TO_2000 946684800
+
+
+class TimeSpan
+{
+  public:
+    TimeSpan(int32_t seconds = 0) : total(seconds) {}
+    int32_t totalseconds() const { return(total); }
+
+  private:
+    int32_t total;
+};
+
+
+class DateTime
+{
+  public:
+    DateTime(uint32_t t = SECONDS_FROM_1970_TO_2000);
+    DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour = 0, uint8_t min = 0, uint8_t sec = 0);
+    DateTime(const char* date, const char* time);
+
+    uint16_t year() const { return(2000 + yOff); }
+    uint8_t month() const { return(m); }
+    uint8_t day() const { return(d); }
+    uint8_t hour() const { return(hh); }
+    uint8_t minute() const { return(mm); }
+    uint8_t second() const { return(ss); }
+    uint8_t dayOfTheWeek() const;
+
+    uint32_t unixtime() const;
+
+    DateTime operator+(const TimeSpan& span) const { return(DateTime(unixtime() + span.totalseconds())); }
+    DateTime operator-(const TimeSpan& span) const { return(DateTime(unixtime() - span.totalseconds())); }
+
+
+  private:
+    uint8_t yOff, m, d, hh, mm, ss;
+};
+
+
+enum Ds1307SqwPinMode { OFF = 0x00, ON = 0x80, SquareWave1HZ = 0x10, SquareWave4kHz = 0x11, SquareWave8kHz = 0x12, SquareWave32kHz = 0x13 };
+
+
+class RTC_DS1307
+{
+  public:
+    bool begin();
+    void adjust(const DateTime& dt);
+    DateTime now();
+    uint8_t isrunning() { return(1); }
+    void writeSqwPinMode(Ds1307SqwPinMode mode) { sqwMode = mode; }
+    Ds1307SqwPinMode readSqwPinMode() { return(sqwMode); }
+
+    static unsigned long hostReads() { return(reads); }
+
+
+  private:
+    static uint32_t base;  //Unix time the clock was set to...
+    static unsigned long baseMillis;  //...and millis() at that moment. Shared, since the chip is shared by all copies
+    static unsigned long reads;
+    static Ds1307SqwPinMode sqwMode;
+};
+
+
+#endif
@@ -0,0 +1,36 @@
+/*
+  Host stand-in for the SPI library. Nothing is connected to the bus on the host: transfers read back 0xFF,
+  which is what a floating MISO line reads on the board.
+*/
+
+#ifndef SPI_h
+#define SPI_h
+
+#include "Arduino.h"
+
+
+#define MSBFIRST 1
+#define SPI_MODE0 0x00
+
+
+class SPISettings
+{
+  public:
+    SPISettings() {}
+    SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) { (void)clock; (void)bitOrder; (void)dataMode; }
+};
+
+
+class SPIClass
+{
+  public:
+    void begin() {}
+    void beginTransaction(SPISettings settings) { (void)settings; }
+    void endTransaction() {}
+    uint8_t transfer(uint8_t data) { (void)data; return(0xFF); }
+};
+
+extern SPIClass SPI;
+
+
+#endif
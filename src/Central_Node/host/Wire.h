@@ -0,0 +1,20 @@
+/*
+  Host stand-in for the Wire (I2C) library. The only I2C device, the DS1307, is simulated by RTClib.h.
+*/
+
+#ifndef Wire_h
+#define Wire_h
+
+#include "Arduino.h"
+
+
+class TwoWire
+{
+  public:
+    void begin() {}
+};
+
+extern TwoWire Wire;
+
+
+#endif
@@ -0,0 +1,109 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This code has been developed for the final project of my career, an Arduino Smart Alarm. You may reuse all or part
+  of the included code freely for non-commercial purposes.
+
+  Entry point of the native Linux build of the Central Node. It runs the unmodified sketch (setup() once, then
+  loop() over and over) on top of the host stand-ins in this folder. Options:
+    -n PASSES   Stop after this many passes of loop() (default: run forever)
+    -a PASSES   Inject a Window Node alert every PASSES passes, to load the radio path
+    -b COUNT    Number of alerts injected together each time (default 1), to simulate a burst of sensors
+    -t PASSES   Send a heartbeat from the Window Node every PASSES passes
+    -u NODE     Make the node with this (octal) address unreachable, as if it were powered off
+    -s          Print the LCD contents and some counters when finished
+    -m FILE     Keep the passcode database in FILE (memory mapped) instead of the emulated EEPROM
+    -h          Print this list of options
+*/
+
+#include <unistd.h>
+
+#include "Arduino.h"
+#include "../Central_Node.ino"
+#include "MappedFileStorage.h"
+
+
+//Prints the list of options
+static void PrintUsage(FILE* output, const char* name)
+{
+  fprintf(output, "Usage: %s [-n passes] [-a alert period] [-b burst] [-t heartbeat period] [-u node] [-s] [-m storage file] [-h]\n", name);
+  fprintf(output, "  -n PASSES   Stop after this many passes of loop() (default: run forever)\n");
+  fprintf(output, "  -a PASSES   Inject a Window Node alert every PASSES passes\n");
+  fprintf(output, "  -b COUNT    Number of alerts injected together each time (default 1)\n");
+  fprintf(output, "  -t PASSES   Send a heartbeat from the Window Node every PASSES passes\n");
+  fprintf(output, "  -u NODE     Make the node with this (octal) address unreachable\n");
+  fprintf(output, "  -s          Print the LCD contents and some counters when finished\n");
+  fprintf(output, "  -m FILE     Keep the passcode database in FILE (memory mapped)\n");
+  fprintf(output, "  -h          Print this list of options\n");
+}
+
+
+
+int main(int argc, char** argv)
+{
+  unsigned long passes = 0;
+  unsigned long alertPeriod = 0;
+  unsigned long burst = 1;
+  unsigned long heartbeatPeriod = 0;
+  uint16_t unreachable[8];
+  int unreachableCount = 0;
+  bool summary = false;
+  const char* storageFile = NULL;
+
+  int option;
+  while ((option = getopt(argc, argv, "n:a:b:t:u:sm:h")) != -1){
+    switch (option){
+      case 'n': passes = strtoul(optarg, NULL, 10); break;
+      case 'a': alertPeriod = strtoul(optarg, NULL, 10); break;
+      case 'b': burst = strtoul(optarg, NULL, 10); break;
+      case 't': heartbeatPeriod = strtoul(optarg, NULL, 10); break;
+      case 'u': unreachable[unreachableCount++ % 8] = strtoul(optarg, NULL, 8); break;
+      case 's': summary = true; break;
+      case 'm': storageFile = optarg; break;
+      case 'h':
+        PrintUsage(stdout, argv[0]);
+        return(0);
+      default:
+        PrintUsage(stderr, argv[0]);
+        return(1);
+    }
+  }
+
+  if (storageFile){
+    static MappedFileStorage mappedStorage(storageFile, 64 * 1024);
+    if (!mappedStorage.isOpen()){
+      fprintf(stderr, "Could not map %s\n", storageFile);
+      return(1);
+    }
+    Settings::setPasscodeStorage(mappedStorage, 0);
+  }
+
+  setvbuf(stdout, NULL, _IOLBF, 0);  //So that Serial output shows up as it happens, like on the board
+  setup();
+  for (int i = 0; i < unreachableCount && i < 8; i++) RF24Network::hostInstance->hostSetReachable(unreachable[i], false);
+
+  unsigned long start = micros();
+  for (unsigned long i = 0; passes == 0 || i < passes; i++){
+    if (alertPeriod && i % alertPeriod == 0){
+      for (unsigned long j = 0; j < burst; j++) RF24Network::hostInstance->hostInject(04, 'G', NULL, 0);
+    }
+    if (heartbeatPeriod && i % heartbeatPeriod == 0){
+      const byte heartbeat[2] = {'G', 1};  //Type and zone
+      RF24Network::hostInstance->hostInject(04, 'H', heartbeat, sizeof(heartbeat));
+    }
+    loop();
+  }
+  unsigned long elapsed = micros() - start;
+  Settings::flush();  //The host program is the only way the Central Node ever shuts down
+
+  if (summary){
+    printf("\n");
+    LiquidCrystal::hostInstance->hostDump();
+    printf("Passes: %lu in %lu us (%.3f us/pass)\n", passes, elapsed, passes ? (double)elapsed / passes : 0.0);
+    printf("LCD bus operations: %lu\n", LiquidCrystal::hostInstance->hostBusOperations());
+    printf("RTC reads: %lu\n", RTC_DS1307::hostReads());
+    printf("EEPROM writes: %lu\n", EEPROM.getWriteCount());
+    printf("Radio frames dropped: %lu\n", RF24Network::hostInstance->hostDropped());
+    communications.printStats();
+  }
+  return(0);
+}
@@ -0,0 +1,14 @@
+/*
+  Host stand-in for the printf.h helper shipped with RF24. On the host printf() already writes to stdout.
+*/
+
+#ifndef printf_h
+#define printf_h
+
+#include "Arduino.h"
+
+
+inline void printf_begin() {}
+
+
+#endif
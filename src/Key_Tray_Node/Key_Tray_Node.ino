@@ -21,6 +21,9 @@
 #include <SPI.h>
 #include <RF24.h>
 #include <RF24Network.h>
+#include <TimerWheel.h>  //Software timers (see src/libraries)
+#include <EEPROM.h>  //Used by NodeIdentity.h
+#include <NodeIdentity.h>  //Heartbeats to the Central Node (see src/libraries)
 
 #include <MFRC522.h>  //RFID library
 
@@ -50,6 +53,7 @@ char keys[ROWS][COLS] =
 ////Related to RFID
 #define SS_PIN 32  //Chip Select or SDA
 #define RST_PIN 33  //RST
+const unsigned long RFIDRESTARTINTERVAL = 3000;  //Milliseconds between restarts of the reader
 
 
 ////Related to nRF24
@@ -57,6 +61,8 @@ const int CEpin = 48;  //Chip Enable
 const int SCNpin = 49;  //Chip Select Not
 const int CHANNEL = 100;
 const uint16_t ADDRESS = 3;
+const unsigned char NODETYPE = 'K';  //Key Tray. Sent with the heartbeats
+const unsigned long HEARTBEATINTERVAL = 60000;  //Milliseconds between heartbeats. Must match the Central Node's
 
 
 ////Related to LEDS
@@ -76,6 +82,11 @@ MFRC522 mfrc522(SS_PIN, RST_PIN);
 RF24 radio(CEpin,SCNpin);
 RF24Network network(radio);
 
+//Timers for the periodic tasks
+SizedTimerWheel<> timers;
+Timer rfidRestartTimer;
+Timer heartbeatTimer;
+
 ////Other useful variables
 uint8_t state;  //Stores current state of the state machine
 byte passcode[PASSCODELENGTH];  //Stores the passcode input by the user
@@ -105,6 +116,10 @@ void setup()
   mfrc522.PCD_Init();    // Initialize MFRC522 Hardware
   mfrc522.PCD_SetAntennaGain(mfrc522.RxGain_max); //Set Antenna Gain to Max. This will increase reading distance
   
+  ////Start the periodic tasks
+  timers.start(rfidRestartTimer, RFIDRESTARTINTERVAL, RestartRFIDReader, NULL, RFIDRESTARTINTERVAL);
+  timers.start(heartbeatTimer, HEARTBEATINTERVAL, SendHeartbeat, NULL, HEARTBEATINTERVAL);
+  
   ////Setup the State Machine
   state = 1;
   printf_P(PSTR("\n--Advancing to state 1 (Alarm deactivated)--\nPress * to activate alarm, or press # to add a new passcode.\n"));
@@ -119,6 +134,9 @@ void loop()
 { 
   char pressedKey = keypad.getKey();
   network.update(); 
+  
+  //Run the timers that have expired (RFID reader restarts and heartbeats)
+  timers.update();
  
   
   //This module works as a state machine. The variable 'state' indicates the current state. 
@@ -269,9 +287,6 @@ void loop()
       state = 1;
     
   }
-    
-  //Last minute modification to try solving bug in which RFID reader randomly stops working until the node is reset
-  RestartRFIDReader();
 }
 
 
@@ -378,14 +393,18 @@ void getRFIDpasscode()
 
 
 
-void RestartRFIDReader(){
+//Last minute modification to try solving bug in which RFID reader randomly stops working until the node is reset.
+//Called by rfidRestartTimer every few seconds.
+void RestartRFIDReader(void* context){
 
-  static long lastRestart = millis();
-  
-  if(millis()-lastRestart>3000)
-  {
-    mfrc522.PCD_Init();    // Initialize MFRC522 Hardware
-    mfrc522.PCD_SetAntennaGain(mfrc522.RxGain_max); //Set Antenna Gain to Max. This will increase reading distance
-    lastRestart = millis();
-  }
+  mfrc522.PCD_Init();    // Initialize MFRC522 Hardware
+  mfrc522.PCD_SetAntennaGain(mfrc522.RxGain_max); //Set Antenna Gain to Max. This will increase reading distance
+}
+
+
+
+//Tells the Central Node that this node is still alive
+void SendHeartbeat(void* context)
+{
+  if(!NodeIdentity::sendHeartbeat(network, NODETYPE)) printf_P(PSTR("\nHeartbeat failed\n"));
 }
@@ -15,12 +15,19 @@
 #include <printf.h>
 #include <RF24.h>
 #include <RF24Network.h>
+#include <EEPROM.h>  //Used by NodeIdentity.h
+#include <NodeIdentity.h>  //Address, zone, registration and heartbeats of this node (see src/libraries)
+#include <TimerWheel.h>  //Software timers (see src/libraries)
 
 ///////////////////////////////////////////////////////////
 ////CONSTANTS//////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 const int CHANNEL = 100;
-const uint16_t ADDRESS = 1;  //Movement detector nodes all have address 1
+const uint16_t DEFAULTADDRESS = 1;  //Used until the node is given its own address (see NodeIdentity.h)
+const int IDENTITYADDRESS = 0;  //Address (2 bytes) and zone of this node in its EEPROM
+const int CONFIGTIME = 3;  //Seconds to wait for a new address and zone over Serial at power on
+const unsigned char ALERTTYPE = 'E';  //Type of the alerts sent by Movement Detector Nodes
+const unsigned long HEARTBEATINTERVAL = 60000;  //Milliseconds between heartbeats. Must match the Central Node's
 
 const int PIR_PIN = 5;
 const int LED_PIN = 3;
@@ -34,6 +41,11 @@ const int CALIBRATION_TIME = 10;  //Seconds the node will remain unactive on
 RF24 radio(9,10);
 RF24Network network(radio);
 
+SizedTimerWheel<4> timers;  //16 slots per level (96 bytes): this board only has 2 KB of RAM
+Timer heartbeatTimer;
+
+NodeIdentity identity(ALERTTYPE, DEFAULTADDRESS, IDENTITYADDRESS);  //Address of this node in the network and zone it guards
+
 
 ///////////////////////////////////////////////////////////
 ///////SETUP///////////////////////////////////////////////
@@ -48,12 +60,20 @@ void setup()
   pinMode(PIR_PIN,INPUT);
   pinMode(LED_PIN,OUTPUT);
   
-  ////Bring up the RF network
+  ////Load (or change) the identity of this node
+  identity.load();
+  identity.configure(CONFIGTIME);
+  
+  ////Bring up the RF network and announce this node to the Central Node
   radio.begin();
-  network.begin(CHANNEL,ADDRESS);  //Also prints radio properties
+  network.begin(CHANNEL,identity.getAddress());  //Also prints radio properties
+  identity.announce(network);
   
   ////Setup PIR sensor
   CalibratePIR();
+  
+  ////Let the Central Node know that this node is still alive, every HEARTBEATINTERVAL
+  timers.start(heartbeatTimer, HEARTBEATINTERVAL, SendHeartbeat, NULL, HEARTBEATINTERVAL);
 
 }
 
@@ -71,13 +91,19 @@ void loop()
     
     sendAlert();   //Send wireless message to Central Node
      
-    while(digitalRead(PIR_PIN)) delay(10);  //Wait until the sensor's signal goes low
+    while(digitalRead(PIR_PIN)){  //Wait until the sensor's signal goes low, without missing any heartbeat
+      timers.update();
+      delay(10);
+    }
       
     digitalWrite(LED_PIN,LOW);
     
     printf_P(PSTR("Movement interrupted\n\n"));
   }
   
+  //Run the timers that have expired (heartbeats)
+  timers.update();
+  
   delay(100);   
 }
 
@@ -113,9 +139,18 @@ void CalibratePIR()
 //Send an alert message to Central Node
 void sendAlert()
 {
-  RF24NetworkHeader header(0, 'E'); //(to node, type)
+  RF24NetworkHeader header(0, ALERTTYPE); //(to node, type)
   
   printf_P(PSTR("---------------------------------\n\r"));
   printf_P(PSTR("APP Sending alert to Central Node...\n\r"));
   if(network.write(header,0,0)) printf_P(PSTR("Sent ok\n"));
 }
+
+
+//Tells the Central Node that this node is still alive. Carries the same information as the registration
+void SendHeartbeat(void* context)
+{
+  printf_P(PSTR("Heartbeat... "));
+  if(NodeIdentity::sendHeartbeat(network, ALERTTYPE, identity.getZone())) printf_P(PSTR("Sent ok\n"));
+  else printf_P(PSTR("Failed\n"));
+}
@@ -19,14 +19,23 @@
 #include <RF24.h>
 #include <RF24Network.h>
 
+#include <EEPROM.h>  //Used by NodeIdentity.h
+#include <NodeIdentity.h>  //Address, zone, registration and heartbeats of this node (see src/libraries)
+
 #include <avr/sleep.h>
+#include <avr/wdt.h>  //The watchdog wakes the node up to send its heartbeats
 #include <EnableInterrupt.h>
 
 ///////////////////////////////////////////////////////////
 ////CONSTANTS//////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 const int CHANNEL = 100;
-const uint16_t ADDRESS = 4;  //Window Nodes all have address 4
+const uint16_t DEFAULTADDRESS = 4;  //Used until the node is given its own address (see NodeIdentity.h)
+const int IDENTITYADDRESS = 0;  //Address (2 bytes) and zone of this node in its EEPROM
+const int CONFIGTIME = 3;  //Seconds to wait for a new address and zone over Serial at power on
+const unsigned char ALERTTYPE = 'G';  //Type of the alerts sent by Window Nodes
+const int HEARTBEATWAKEUPS = 7;  //The watchdog wakes the node every 8 s. A heartbeat is sent every 7 wakeups (56 s), 
+                                 //so that it arrives within the Central Node's 60 s interval despite the watchdog's inaccuracy
 
 const int SWITCHpin = 2;  //Used as an Interrupt pin
 const int LEDpin = 4;
@@ -38,6 +47,11 @@ const int LEDpin = 4;
 RF24 radio(9,10);
 RF24Network network(radio);
 
+NodeIdentity identity(ALERTTYPE, DEFAULTADDRESS, IDENTITYADDRESS);  //Address of this node in the network and zone it guards
+
+volatile bool switchTriggered = false;  //Set when the switch wakes the node up (and not the watchdog)
+uint8_t wakeups = 0;  //Watchdog wakeups since the last heartbeat
+
 
 ///////////////////////////////////////////////////////////
 ///////SETUP///////////////////////////////////////////////
@@ -53,10 +67,16 @@ void setup()
   ////Prepare I/O pins
   pinMode(LEDpin,OUTPUT);
   
-  ////Bring up the RF network
+  ////Load (or change) the identity of this node
+  identity.load();
+  identity.configure(CONFIGTIME);
+  
+  ////Bring up the RF network and announce this node to the Central Node
   radio.begin();
-  network.begin(CHANNEL,ADDRESS);  //Also prints radio properties
+  network.begin(CHANNEL,identity.getAddress());  //Also prints radio properties
+  identity.announce(network);
   
+  SetupWatchdog();
   ActivationSignal();
 }
 
@@ -67,12 +87,20 @@ void setup()
 ///////////////////////////////////////////////////////////
 void loop()
 {
-  ATmega328pGoToSleep();  //Go to sleep until woken by an external interrupt caused by the switch.
+  ATmega328pGoToSleep();  //Go to sleep until woken by an external interrupt caused by the switch, or by the watchdog
   
-  delay(300);
-  
-  SendAlert();
-  LEDsignal();
+  if (switchTriggered){
+    switchTriggered = false;
+    printf_P(PSTR("Wake up\n"));
+    delay(300);
+    
+    SendAlert();
+    LEDsignal();
+  }
+  else if (++wakeups >= HEARTBEATWAKEUPS){
+    wakeups = 0;
+    SendHeartbeat();
+  }
 }
 
 
@@ -96,11 +124,10 @@ void ActivationSignal()
 }
 
 
-
 //Send an alert message to Central Node.
 void SendAlert()
 {
-  RF24NetworkHeader header(0, 'G'); //(to node, type)
+  RF24NetworkHeader header(0, ALERTTYPE); //(to node, type)
   
   printf_P(PSTR("---------------------------------\n\r"));
   printf_P(PSTR("APP Sending alert to Central Node...\n\r"));
@@ -152,7 +179,7 @@ void ATmega328pGoToSleep()
 
 
 /*
-ISR (Interrupt service routine). Run when waking up from sleep
+ISR (Interrupt service routine). Run when the switch wakes the node up from sleep
 Delays, timers and serial don't work until interrupts are detached
 */
 void Wake()  
@@ -162,7 +189,35 @@ void Wake()
   //Detach interrupts to prevent unwanted wakeups in the future
   disableInterrupt(SWITCHpin);
   
-  delay(100);
-  printf_P(PSTR("Wake up\n"));
-  delay(100);
+  switchTriggered = true;
+}
+
+
+
+//Sets the watchdog to wake the node up every 8 s with an interrupt (instead of resetting it)
+void SetupWatchdog()
+{
+  noInterrupts();
+  MCUSR &= ~bit(WDRF);
+  WDTCSR = bit(WDCE) | bit(WDE);  //Timed sequence to change the watchdog's settings
+  WDTCSR = bit(WDIE) | bit(WDP3) | bit(WDP0);  //Interrupt mode, 8 s
+  interrupts();
+}
+
+
+
+//ISR of the watchdog. There is nothing to do here: waking the node up is all that is needed
+ISR(WDT_vect)
+{
+  sleep_disable();
+}
+
+
+
+//Tells the Central Node that this node is still alive. Carries the same information as the registration
+void SendHeartbeat()
+{
+  printf_P(PSTR("Heartbeat... "));
+  if(NodeIdentity::sendHeartbeat(network, ALERTTYPE, identity.getZone())) printf_P(PSTR("Sent ok\n"));
+  else printf_P(PSTR("Failed\n"));
 }
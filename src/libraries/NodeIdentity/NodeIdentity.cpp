@@ -0,0 +1,112 @@
+#include "NodeIdentity.h"
+#include <EEPROM.h>
+
+
+//Constructor. The identity is not valid until load() is called
+NodeIdentity::NodeIdentity(unsigned char myType, uint16_t myDefaultAddress, int myEepromAddress)
+{
+  type = myType;
+  defaultAddress = myDefaultAddress;
+  eepromAddress = myEepromAddress;
+  address = myDefaultAddress;
+  zone = 0;
+}
+
+
+
+//Loads the address and zone of this node from its EEPROM. A node that has never been given its own address uses the default one
+void NodeIdentity::load()
+{
+  address = word(EEPROM.read(eepromAddress+1), EEPROM.read(eepromAddress));
+  zone = EEPROM.read(eepromAddress+2);
+  if (!isValidAddress(address)){
+    address = defaultAddress;
+    zone = 0;
+  }
+}
+
+
+
+//Waits the given seconds for a new address and zone over Serial, like "014 2", and stores them in the EEPROM
+void NodeIdentity::configure(unsigned int seconds)
+{
+  printf_P(PSTR("Address %o, zone %u. Send \"<octal address> <zone>\" within %u s to change them\n"),address,zone,seconds);
+  Serial.setTimeout(seconds*1000UL);
+  
+  char line[16];
+  size_t length = Serial.readBytesUntil('\n', line, sizeof(line)-1);
+  if (length == 0) return;
+  line[length] = '\0';
+  
+  char* end;
+  uint16_t newAddress = strtoul(line, &end, 8);
+  uint8_t newZone = strtoul(end, NULL, 10);
+  if (!isValidAddress(newAddress)){
+    printf_P(PSTR("Invalid address\n"));
+    return;
+  }
+  
+  address = newAddress;
+  zone = newZone;
+  EEPROM.update(eepromAddress, lowByte(address));
+  EEPROM.update(eepromAddress+1, highByte(address));
+  EEPROM.update(eepromAddress+2, zone);
+  printf_P(PSTR("New address %o, zone %u\n"),address,zone);
+}
+
+
+
+//Announces this node to the Central Node, telling it the type of its alerts and its zone. Returns true if it was sent
+bool NodeIdentity::announce(RF24Network& network)
+{
+  printf_P(PSTR("Registering with Central Node... "));
+  bool sent = sendToCentralNode(network, 'R', type, zone);
+  if (sent) printf_P(PSTR("Sent ok\n"));
+  else printf_P(PSTR("Failed\n"));
+  return(sent);
+}
+
+
+
+uint16_t NodeIdentity::getAddress() const
+{
+  return(address);
+}
+
+
+
+uint8_t NodeIdentity::getZone() const
+{
+  return(zone);
+}
+
+
+
+//Tells the Central Node that a node of the given type is still alive. Returns true if it was sent
+bool NodeIdentity::sendHeartbeat(RF24Network& network, unsigned char nodeType, uint8_t nodeZone)
+{
+  return(sendToCentralNode(network, 'H', nodeType, nodeZone));
+}
+
+
+
+//Sends a registration or a heartbeat. Both carry the type of the node and its zone
+bool NodeIdentity::sendToCentralNode(RF24Network& network, unsigned char messageType, unsigned char nodeType, uint8_t nodeZone)
+{
+  RF24NetworkHeader header(0, messageType); //(to node, type)
+  byte payload[2] = {nodeType, nodeZone};
+  return(network.write(header,payload,sizeof(payload)));
+}
+
+
+
+//RF24Network addresses have up to 4 octal digits, each from 1 to 5. Address 0 is the Central Node
+bool NodeIdentity::isValidAddress(uint16_t candidate)
+{
+  if ((candidate == 0) || (candidate > 05555)) return(false);
+  for (; candidate; candidate >>= 3){
+    uint8_t digit = candidate & 07;
+    if ((digit < 1) || (digit > 5)) return(false);
+  }
+  return(true);
+}
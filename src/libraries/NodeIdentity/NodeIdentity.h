@@ -0,0 +1,63 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This library has been made for the final project of my career, an Arduino Smart Alarm. You may reuse all or part 
+  of the included code freely for non-commercial purposes.
+  
+  Identity of a sensor node (Movement Detector or Window Node) in the network: its address and the zone of the 
+  building it guards, and the type of the alerts it sends. Both sensors share this code, so that they validate 
+  addresses and register with the Central Node in the same way.
+   - load() reads the address and zone from the node's EEPROM. A node that has never been given its own address 
+     uses the default one, like older firmware did.
+   - configure() waits a few seconds at power on for a new address and zone over Serial: a line with the address 
+     in octal (as RF24Network addresses are written) and the zone, like "014 2". They are stored in the EEPROM and 
+     used from then on. Each sensor of the building must get a different address.
+   - announce() registers the node with the Central Node (message type R), telling it its type and zone.
+  sendHeartbeat() sends the heartbeat every node sends to the Central Node (message type H), with the same payload 
+  as the registration. It is static, so the nodes that have no identity of their own (siren, Key Tray) use it too, 
+  with their own type.
+  
+  Usage:
+    NodeIdentity identity('E', 1);  //Alert type and default address. Stored from EEPROM address 0
+    
+    setup():  identity.load();
+              identity.configure(3);
+              network.begin(CHANNEL, identity.getAddress());
+              identity.announce(network);
+    heartbeat: NodeIdentity::sendHeartbeat(network, 'E', identity.getZone());
+*/
+
+#ifndef NodeIdentity_h
+#define NodeIdentity_h
+
+
+#include <Arduino.h>
+#include <RF24Network.h>
+
+
+class NodeIdentity
+{
+  public:
+    NodeIdentity(unsigned char myType, uint16_t myDefaultAddress, int myEepromAddress = 0);
+    void load();
+    void configure(unsigned int seconds);
+    bool announce(RF24Network& network);
+    
+    uint16_t getAddress() const;
+    uint8_t getZone() const;
+    static bool isValidAddress(uint16_t candidate);
+    static bool sendHeartbeat(RF24Network& network, unsigned char nodeType, uint8_t nodeZone = 0);
+    
+    
+  private:
+    unsigned char type;  //Type of the alerts sent by the node
+    uint16_t defaultAddress;
+    int eepromAddress;  //Where the address (2 bytes) and zone are stored in the node's EEPROM
+    
+    uint16_t address;
+    uint8_t zone;
+    
+    static bool sendToCentralNode(RF24Network& network, unsigned char messageType, unsigned char nodeType, uint8_t nodeZone);
+};
+
+
+#endif
@@ -0,0 +1,159 @@
+#include "TimerWheel.h"
+
+
+//Constructor. A new timer is stopped
+Timer::Timer()
+{
+  next = NULL;
+  previous = NULL;
+}
+
+
+
+//Returns true if the timer has been started and has not expired (or been cancelled) yet. Periodic timers keep running
+bool Timer::isRunning() const
+{
+  return(previous != NULL);
+}
+
+
+
+
+//Constructor. The slots belong to the SizedTimerWheel, which chooses how many there are
+TimerWheel::TimerWheel(Timer** mySlots, uint8_t mySlotBits)
+{
+  slots = mySlots;
+  slotBits = mySlotBits;
+  slotMask = ((uint32_t)1 << slotBits) - 1;
+  memset(slots, 0, TIMERWHEEL_LEVELS * ((size_t)1 << slotBits) * sizeof(Timer*));
+  currentTick = millis();
+}
+
+
+
+/*
+Starts a timer. After the given milliseconds, callback(context) will be called from update(). If period is not 0, 
+it will be called again every period milliseconds until the timer is cancelled. A timer that was already running 
+is restarted. The callback may start or cancel any timer, including its own.
+*/
+void TimerWheel::start(Timer& timer, unsigned long milliseconds, TimerCallback callback, void* context, unsigned long period)
+{
+  if (timer.isRunning()) unlink(timer);
+  
+  timer.callback = callback;
+  timer.context = context;
+  timer.period = period;
+  timer.expires = millis() + milliseconds;
+  if ((int32_t)(timer.expires - currentTick) <= 0) timer.expires = currentTick + 1;  //The slot of currentTick has already been processed
+  insert(timer);
+}
+
+
+
+//Stops a timer. Nothing happens if it wasn't running
+void TimerWheel::cancel(Timer& timer)
+{
+  if (timer.isRunning()) unlink(timer);
+}
+
+
+
+/*
+Must be called regularly (on every pass of the loop). Calls the callbacks of the timers that have expired since 
+the last call, in the order in which they expired.
+*/
+void TimerWheel::update()
+{
+  uint32_t now = millis();
+  
+  while (currentTick != now){
+    currentTick++;
+    
+    //When the first level completes a turn, bring down the timers of the next slot of the higher levels
+    if ((currentTick & slotMask) == 0){
+      cascade(1);
+      if (((currentTick >> slotBits) & slotMask) == 0) cascade(2);
+    }
+    
+    Timer** expired = slot(0, currentTick);
+    while (*expired) expire(**expired);  //Each expired timer is taken out of the slot before its callback is called
+  }
+}
+
+
+
+//Returns the slot of the given level that holds the timers expiring at the given tick
+Timer** TimerWheel::slot(int level, uint32_t tick)
+{
+  return(&slots[((uint16_t)level << slotBits) + ((tick >> (level*slotBits)) & slotMask)]);
+}
+
+
+
+//Puts a timer in the slot that corresponds to its expiry time
+void TimerWheel::insert(Timer& timer)
+{
+  uint32_t delta = timer.expires - currentTick;
+  Timer** timerSlot;
+  
+  if (delta < ((uint32_t)1 << slotBits)){
+    timerSlot = slot(0, timer.expires);
+  }
+  else if (delta < ((uint32_t)1 << (2*slotBits))){
+    timerSlot = slot(1, timer.expires);
+  }
+  else if (delta < ((uint32_t)1 << (3*slotBits))){
+    timerSlot = slot(2, timer.expires);
+  }
+  else{  //Too far away: park it in the furthest slot. It will be moved again when it comes up
+    timerSlot = slot(2, currentTick + ((uint32_t)1 << (3*slotBits)) - 1);
+  }
+  
+  timer.next = *timerSlot;
+  if (timer.next) timer.next->previous = &timer.next;
+  timer.previous = timerSlot;
+  *timerSlot = &timer;
+}
+
+
+
+//Takes a timer out of its slot
+void TimerWheel::unlink(Timer& timer)
+{
+  *timer.previous = timer.next;
+  if (timer.next) timer.next->previous = timer.previous;
+  timer.next = NULL;
+  timer.previous = NULL;
+}
+
+
+
+//Moves the timers of the current slot of a level to the lower levels
+void TimerWheel::cascade(int level)
+{
+  Timer** cascaded = slot(level, currentTick);
+  
+  Timer* timer = *cascaded;
+  *cascaded = NULL;
+  while (timer){
+    Timer* next = timer->next;
+    insert(*timer);
+    timer = next;
+  }
+}
+
+
+
+//Takes an expired timer out of the wheel, restarts it if it is periodic, and calls its callback
+void TimerWheel::expire(Timer& timer)
+{
+  unlink(timer);
+  
+  if (timer.period){
+    timer.expires += timer.period;
+    if ((int32_t)(timer.expires - currentTick) <= 0) timer.expires = currentTick + 1;  //update() was called late
+    insert(timer);
+  }
+  
+  timer.callback(timer.context);
+}
@@ -0,0 +1,111 @@
+/*
+  Copyright (C) 2015 E. Tiron <Eduard.Tiron@gmail.com>
+  This library has been made for the final project of my career, an Arduino Smart Alarm. You may reuse all or part 
+  of the included code freely for non-commercial purposes.
+  
+  Software timers for all the nodes, so that none of them has to compare millis() by hand or wait with delay(). 
+  A Timer calls a function after some milliseconds, once or periodically. Any number of timers can be running: 
+  they are kept in a hierarchical timing wheel, so starting, cancelling and expiring a timer take the same time no 
+  matter how many there are, and update() doesn't have to look at every timer on each pass of the loop.
+  
+  How it works: the wheel has TIMERWHEEL_LEVELS levels of N slots each. A slot of the first level holds the timers 
+  that expire in a given millisecond of the next N ms; a slot of the second level, those that expire in a given 
+  block of N ms further away, and so on. Each time the first level 
+  completes a turn, the timers of the next slot of the second level are moved down to the first level (and the 
+  same between the second and third levels). Timers further away than the last level can reach are parked in its 
+  furthest slot and moved again when it comes up.
+  
+  Timers are intrusive: the caller owns the Timer object (usually a global or a member of its class) and the wheel 
+  only links them together, so no memory is ever allocated. A Timer must not be destroyed while it is running.
+  The number of slots is chosen by each sketch: SizedTimerWheel<SlotBits> has 2^SlotBits slots per level, and takes 
+  TIMERWHEEL_LEVELS * 2^SlotBits pointers of RAM (384 bytes with the default 64 slots on an ATmega). Nodes with 
+  little RAM and only a few timers can use a smaller wheel, like SizedTimerWheel<4> (96 bytes): timers further away 
+  than it reaches are just parked and moved more often. Code that only starts and cancels timers takes a 
+  TimerWheel&, which works with a wheel of any size.
+  
+  Usage:
+    SizedTimerWheel<> timers;
+    Timer blinkTimer;
+    void blink(void* context) { ... }
+    
+    setup():  timers.start(blinkTimer, 500, blink, NULL, 500);  //After 500 ms, then every 500 ms
+    loop():   timers.update();
+*/
+
+#ifndef TimerWheel_h
+#define TimerWheel_h
+
+
+#include "Arduino.h"
+
+
+const int TIMERWHEEL_LEVELS = 3;
+const uint8_t TIMERWHEEL_SLOTBITS = 6;  //Default size of the wheel: 64 slots per level
+
+typedef void (*TimerCallback)(void* context);
+
+
+
+class Timer
+{
+  public:
+    Timer();
+    bool isRunning() const;
+    
+    
+  private:
+    friend class TimerWheel;
+    
+    Timer* next;
+    Timer** previous;  //Pointer that points to this timer (the slot, or the 'next' of the previous timer). NULL if stopped
+    uint32_t expires;  //Tick (millisecond) at which it expires
+    uint32_t period;  //0 for timers that run once
+    TimerCallback callback;
+    void* context;
+};
+
+
+
+class TimerWheel
+{
+  public:
+    void start(Timer& timer, unsigned long milliseconds, TimerCallback callback, void* context = NULL, unsigned long period = 0);
+    void cancel(Timer& timer);
+    void update();
+    
+    
+  protected:
+    TimerWheel(Timer** mySlots, uint8_t mySlotBits);
+    
+    
+  private:
+    Timer** slots;  //TIMERWHEEL_LEVELS levels of 2^slotBits slots, one after the other
+    uint8_t slotBits;
+    uint32_t slotMask;
+    uint32_t currentTick;  //Last millisecond processed
+    
+    Timer** slot(int level, uint32_t tick);
+    void insert(Timer& timer);
+    void unlink(Timer& timer);
+    void cascade(int level);
+    void expire(Timer& timer);
+};
+
+
+
+//A TimerWheel with its slots: 2^SlotBits per level
+template <uint8_t SlotBits = TIMERWHEEL_SLOTBITS>
+class SizedTimerWheel : public TimerWheel
+{
+  static_assert((SlotBits >= 1) && (SlotBits*TIMERWHEEL_LEVELS < 32), "The levels of the wheel must cover less than 2^32 ms");
+  
+  public:
+    SizedTimerWheel() : TimerWheel(&wheelSlots[0][0], SlotBits) {}
+    
+    
+  private:
+    Timer* wheelSlots[TIMERWHEEL_LEVELS][1 << SlotBits];
+};
+
+
+#endif